@@ -3,12 +3,44 @@
 
 #include "CameraConfigVolume.h"
 
+#include "SpiderCameraZoneSubsystem.h"
+#include "Components/BrushComponent.h"
 #include "Components/SplineComponent.h"
+#include "Engine/World.h"
 
 
 ACameraConfigVolume::ACameraConfigVolume()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// Found by the cameras through the camera zone subsystem, the volume neither ticks nor tracks overlaps
+	PrimaryActorTick.bCanEverTick = false;
+	GetBrushComponent()->SetGenerateOverlapEvents(false);
 	bDisplayShadedVolume = true;
 	CameraPath = CreateDefaultSubobject<USplineComponent>(TEXT("Spline"));
 }
+
+void ACameraConfigVolume::BeginPlay()
+{
+	Super::BeginPlay();
+	if (USpiderCameraZoneSubsystem* Zones = GetWorld()->GetSubsystem<USpiderCameraZoneSubsystem>())
+		Zones->RegisterVolume(this);
+}
+
+void ACameraConfigVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USpiderCameraZoneSubsystem* Zones = GetWorld()->GetSubsystem<USpiderCameraZoneSubsystem>())
+		Zones->UnregisterVolume(this);
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACameraConfigVolume::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+	CameraPathTable.Bake(CameraPath, CameraPathSampleSpacing);
+}
+
+const FCameraSplineTable& ACameraConfigVolume::GetCameraPathTable()
+{
+	if (!CameraPathTable.IsBakedFrom(CameraPath, CameraPathSampleSpacing))
+		CameraPathTable.Bake(CameraPath, CameraPathSampleSpacing);
+	return CameraPathTable;
+}
@@ -0,0 +1,103 @@
+#include "CameraSplineTable.h"
+
+#include "Components/SplineComponent.h"
+
+namespace CameraSplineTable
+{
+	// Queries which moved further than this many samples since the last lookup search every sample again
+	constexpr double MaxWalkSamples = 8.0;
+}
+
+void FCameraSplineTable::Bake(const USplineComponent* Spline, const float& InSampleSpacing)
+{
+	BakedSpline = Spline;
+	SampleSpacing = FMath::Max(InSampleSpacing, 1.0f);
+	Points.Reset();
+	if (!Spline) return;
+
+	BakedTransform = Spline->GetComponentTransform();
+	bIsClosedLoop = Spline->IsClosedLoop();
+
+	const float Length = Spline->GetSplineLength();
+	const int32 SegmentCount = FMath::Max(FMath::CeilToInt32(Length / SampleSpacing), 1);
+	Points.SetNumUninitialized(SegmentCount + 1);
+
+	for (int32 i = 0; i <= SegmentCount; i++)
+		Points[i] = Spline->GetLocationAtDistanceAlongSpline(Length * i / SegmentCount, ESplineCoordinateSpace::World);
+}
+
+bool FCameraSplineTable::IsBakedFrom(const USplineComponent* Spline, const float& InSampleSpacing) const
+{
+	return BakedSpline == Spline && Spline && IsBaked() && SampleSpacing == FMath::Max(InSampleSpacing, 1.0f) &&
+		BakedTransform.Equals(Spline->GetComponentTransform()) && bIsClosedLoop == Spline->IsClosedLoop();
+}
+
+int32 FCameraSplineTable::WrapIndex(const int32& Index) const
+{
+	// The last point of a loop doubles the first one, walking past either end comes back on the other
+	const int32 LastIndex = Points.Num() - 1;
+	if (!bIsClosedLoop) return FMath::Clamp(Index, 0, LastIndex);
+	return (Index % LastIndex + LastIndex) % LastIndex;
+}
+
+int32 FCameraSplineTable::FindClosestSample(const FVector& LocationWorld) const
+{
+	int32 ClosestIndex = 0;
+	double ClosestDistanceSquared = TNumericLimits<double>::Max();
+	for (int32 i = 0; i < Points.Num(); i++)
+	{
+		const double DistanceSquared = FVector::DistSquared(Points[i], LocationWorld);
+		if (DistanceSquared >= ClosestDistanceSquared) continue;
+		ClosestDistanceSquared = DistanceSquared;
+		ClosestIndex = i;
+	}
+	return WrapIndex(ClosestIndex);
+}
+
+int32 FCameraSplineTable::WalkToClosestSample(const FVector& LocationWorld, int32 SampleIndex) const
+{
+	// Walk downhill along the samples, the target moves little between frames so this is a few steps at most
+	double DistanceSquared = FVector::DistSquared(Points[SampleIndex], LocationWorld);
+	for (const int32 Direction : {1, -1})
+	{
+		for (int32 Step = 0; Step < Points.Num(); Step++)
+		{
+			const int32 NextIndex = WrapIndex(SampleIndex + Direction);
+			const double NextDistanceSquared = FVector::DistSquared(Points[NextIndex], LocationWorld);
+			if (NextIndex == SampleIndex || NextDistanceSquared >= DistanceSquared) break;
+			SampleIndex = NextIndex;
+			DistanceSquared = NextDistanceSquared;
+		}
+	}
+	return SampleIndex;
+}
+
+FVector FCameraSplineTable::FindLocationClosestTo(const FVector& LocationWorld, FCameraSplineCursor& InOutCursor) const
+{
+	if (!IsBaked()) return LocationWorld;
+
+	// Walking only finds the closest sample nearby, after a teleport or respawn it could stop on the wrong side
+	const double MaxWalkDistance = SampleSpacing * CameraSplineTable::MaxWalkSamples;
+	const bool bCanWalk = Points.IsValidIndex(InOutCursor.SampleIndex) &&
+		FVector::DistSquared(InOutCursor.LocationWorld, LocationWorld) <= FMath::Square(MaxWalkDistance);
+	InOutCursor.SampleIndex = bCanWalk
+		                          ? WalkToClosestSample(LocationWorld, WrapIndex(InOutCursor.SampleIndex))
+		                          : FindClosestSample(LocationWorld);
+	InOutCursor.LocationWorld = LocationWorld;
+
+	// Refine on the segments on both sides of the closest sample
+	const int32 Index = InOutCursor.SampleIndex;
+	const FVector& Point = Points[Index];
+	FVector Closest = Point;
+	double ClosestDistanceSquared = FVector::DistSquared(Point, LocationWorld);
+	for (const int32 NeighbourIndex : {WrapIndex(Index - 1), WrapIndex(Index + 1)})
+	{
+		if (NeighbourIndex == Index) continue;
+		const FVector Candidate = FMath::ClosestPointOnSegment(LocationWorld, Point, Points[NeighbourIndex]);
+		const double DistanceSquared = FVector::DistSquared(Candidate, LocationWorld);
+		if (DistanceSquared >= ClosestDistanceSquared) continue;
+		ClosestDistanceSquared = DistanceSquared;
+		Closest = Candidate;
+	}
+	return Closest;
+}
@@ -0,0 +1,366 @@
+#include "SpiderBenchmarkCommandlet.h"
+
+#include "SpiderCharacter.h"
+#include "SpiderRigCounters.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+// The benchmark drives the editor's commandlet loop, it doesn't ship in game builds
+#if WITH_EDITOR
+namespace SpiderBenchmark
+{
+	// Terrain is made of tilted and stepped boxes, each tile is a scaled 100 unit engine cube
+	constexpr float TileSize = 800.0f;
+	constexpr float TileThickness = 100.0f;
+	constexpr float LedgeHeight = 40.0f;
+	constexpr int32 MaxLedgeSteps = 3;
+	constexpr float MaxSlopeDegrees = 15.0f;
+	constexpr float SlopedTileRatio = 0.35f;
+
+	constexpr int32 WaypointCount = 4;
+	constexpr float WaypointReachedDistance = 150.0f;
+	constexpr float SpawnHeight = 150.0f;
+
+	// Timings compared against the baseline, larger is worse
+	const TCHAR* ComparedTimings[] = {
+		TEXT("ExecuteMsMean"), TEXT("ExecuteMsP95"), TEXT("ExecuteUsPerRig"), TEXT("PreUpdateMsMean"),
+		TEXT("PreUpdateMsP95"),
+	};
+
+	double Percentile(TArray<double> Values, const double& Fraction)
+	{
+		if (Values.IsEmpty()) return 0;
+		Values.Sort();
+		const int32 Index = FMath::Clamp(FMath::CeilToInt32(Fraction * Values.Num()) - 1, 0, Values.Num() - 1);
+		return Values[Index];
+	}
+
+	double Mean(const TArray<double>& Values)
+	{
+		if (Values.IsEmpty()) return 0;
+		double Sum = 0;
+		for (const double& Value : Values)
+			Sum += Value;
+		return Sum / Values.Num();
+	}
+}
+#endif
+
+USpiderBenchmarkCommandlet::USpiderBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Runs a crowd of spiders headless and records how long their rigs take.");
+	HelpUsage = TEXT("-run=SpiderBenchmark -nullrhi -Count=500 -Seed=1 -Frames=600 -Output=<path> -Baseline=<json>");
+}
+
+int32 USpiderBenchmarkCommandlet::Main(const FString& Params)
+{
+#if !WITH_EDITOR
+	UE_LOG(LogTemp, Error, TEXT("USpiderBenchmarkCommandlet::Main -> Benchmarks can only run in the editor"));
+	return 1;
+#elif SPIDERRIG_WITH_COUNTERS
+	CharacterPath = TEXT("/Game/SpiderBot/BP_Robot.BP_Robot_C");
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmark") / TEXT("SpiderRig");
+	FString BaselinePath;
+
+	FParse::Value(*Params, TEXT("Count="), SpiderCount);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Frames="), FrameCount);
+	FParse::Value(*Params, TEXT("Warmup="), WarmupFrameCount);
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaTime);
+	FParse::Value(*Params, TEXT("Threshold="), Threshold);
+	FParse::Value(*Params, TEXT("Character="), CharacterPath);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	FParse::Value(*Params, TEXT("Baseline="), BaselinePath);
+	const bool bUpdateBaseline = FParse::Param(*Params, TEXT("UpdateBaseline"));
+
+	SpiderCount = FMath::Clamp(SpiderCount, 1, 5000);
+	FrameCount = FMath::Max(FrameCount, 1);
+	WarmupFrameCount = FMath::Max(WarmupFrameCount, 0);
+	DeltaTime = FMath::Max(DeltaTime, UE_KINDA_SMALL_NUMBER);
+
+	UClass* CharacterClass = LoadClass<ASpiderCharacter>(nullptr, *CharacterPath);
+	if (!CharacterClass)
+	{
+		UE_LOG(LogTemp, Error, TEXT("USpiderBenchmarkCommandlet::Main -> Invalid character class %s"), *CharacterPath);
+		return 1;
+	}
+
+	TileMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!TileMesh)
+	{
+		UE_LOG(LogTemp, Error, TEXT("USpiderBenchmarkCommandlet::Main -> Missing engine cube mesh"));
+		return 1;
+	}
+
+	// A game world of our own, so the crowd subsystem and async traces behave as they do in game
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("SpiderBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	// Every run with the same seed builds the same terrain and walks the same paths
+	FRandomStream Stream(Seed);
+	BuildTerrain(World, Stream);
+	SpawnSpiders(World, Stream, CharacterClass);
+
+	UE_LOG(LogTemp, Display, TEXT("USpiderBenchmarkCommandlet::Main -> %d spiders, %dx%d tiles, seed %d, %d frames"),
+	       Spiders.Num(), GridSize, GridSize, Seed, FrameCount);
+
+	FSpiderRigCounters& Counters = FSpiderRigCounters::Get();
+	Frames.Reset(FrameCount);
+	for (int32 FrameIndex = 0; FrameIndex < WarmupFrameCount + FrameCount; FrameIndex++)
+	{
+		DriveSpiders();
+		Counters.Reset();
+
+		const double StartSeconds = FPlatformTime::Seconds();
+		World->Tick(LEVELTICK_All, DeltaTime);
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		GFrameCounter++;
+		const double FrameSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		// Warmup frames let the spiders land and the async traces fill up
+		if (FrameIndex < WarmupFrameCount) continue;
+
+		FSpiderBenchmarkFrame& Frame = Frames.AddDefaulted_GetRef();
+		Frame.FrameSeconds = FrameSeconds;
+		Frame.ExecuteSeconds = FPlatformTime::ToSeconds64(Counters.ExecuteCycles.load());
+		Frame.ExecuteCount = Counters.ExecuteCount.load();
+		Frame.PreUpdateSeconds = FPlatformTime::ToSeconds64(Counters.PreUpdateCycles.load());
+		Frame.SweepCount = Counters.SweepsIssued.load();
+		Frame.IKSolveCount = Counters.IKSolveCount.load();
+		Frame.IKIterationCount = Counters.IKIterations.load();
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	const TSharedRef<FJsonObject> Summary = MakeSummary();
+	if (!WriteResults(OutputPath, Summary)) return 1;
+
+	if (BaselinePath.IsEmpty()) return 0;
+	if (bUpdateBaseline)
+	{
+		IFileManager::Get().Copy(*BaselinePath, *(OutputPath + TEXT(".json")));
+		UE_LOG(LogTemp, Display, TEXT("USpiderBenchmarkCommandlet::Main -> Baseline updated %s"), *BaselinePath);
+		return 0;
+	}
+	return CompareBaseline(BaselinePath, Summary) ? 0 : 1;
+#else
+	UE_LOG(LogTemp, Error, TEXT("USpiderBenchmarkCommandlet::Main -> Spider rig counters are compiled out"));
+	return 1;
+#endif
+}
+
+#if WITH_EDITOR
+void USpiderBenchmarkCommandlet::BuildTerrain(UWorld* World, FRandomStream& Stream)
+{
+	using namespace SpiderBenchmark;
+
+	// Enough tiles for about one spider per tile, plus a border the paths stay away from
+	GridSize = FMath::Max(FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(SpiderCount))) + 2, 4);
+	TileLocations.Reset(GridSize * GridSize);
+
+	for (int32 Y = 0; Y < GridSize; Y++)
+	{
+		for (int32 X = 0; X < GridSize; X++)
+		{
+			// Stepped heights make ledges between neighbours, some tiles are tilted into slopes
+			const float Height = Stream.RandRange(0, MaxLedgeSteps) * LedgeHeight;
+			FRotator Rotation = FRotator::ZeroRotator;
+			if (Stream.FRand() < SlopedTileRatio)
+			{
+				Rotation.Pitch = Stream.FRandRange(-MaxSlopeDegrees, MaxSlopeDegrees);
+				Rotation.Roll = Stream.FRandRange(-MaxSlopeDegrees, MaxSlopeDegrees);
+			}
+
+			const FVector TopLocation(X * TileSize, Y * TileSize, Height);
+			TileLocations.Add(TopLocation);
+
+			const FVector Location = TopLocation - FVector(0, 0, TileThickness * 0.5f);
+			AStaticMeshActor* Tile = World->SpawnActor<AStaticMeshActor>(Location, Rotation);
+			if (!Tile) continue;
+
+			UStaticMeshComponent* TileComponent = Tile->GetStaticMeshComponent();
+			TileComponent->SetMobility(EComponentMobility::Movable);
+			TileComponent->SetStaticMesh(TileMesh);
+			Tile->SetActorScale3D(FVector(TileSize, TileSize, TileThickness) / 100.0f);
+		}
+	}
+}
+
+FVector USpiderBenchmarkCommandlet::GetRandomTileLocation(FRandomStream& Stream) const
+{
+	const int32 X = Stream.RandRange(1, GridSize - 2);
+	const int32 Y = Stream.RandRange(1, GridSize - 2);
+	return TileLocations.IsValidIndex(Y * GridSize + X) ? TileLocations[Y * GridSize + X] : FVector::ZeroVector;
+}
+
+void USpiderBenchmarkCommandlet::SpawnSpiders(UWorld* World, FRandomStream& Stream, UClass* CharacterClass)
+{
+	using namespace SpiderBenchmark;
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	Spiders.Reset(SpiderCount);
+	Paths.Reset(SpiderCount);
+	for (int32 i = 0; i < SpiderCount; i++)
+	{
+		const FVector Location = GetRandomTileLocation(Stream) + FVector(0, 0, SpawnHeight);
+		const FRotator Rotation(0, Stream.FRandRange(-180.0f, 180.0f), 0);
+		ASpiderCharacter* Spider = World->SpawnActor<ASpiderCharacter>(CharacterClass, Location, Rotation,
+		                                                               SpawnParameters);
+		if (!Spider) continue;
+
+		// Nobody possesses the spiders, they are driven by their scripted path
+		Spider->GetCharacterMovement()->bRunPhysicsWithNoController = true;
+
+		// Nothing is rendered, the rig still has to run every frame
+		Spider->GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+
+		FSpiderBenchmarkPath& Path = Paths.AddDefaulted_GetRef();
+		for (int32 k = 0; k < WaypointCount; k++)
+			Path.Waypoints.Add(GetRandomTileLocation(Stream));
+		Spiders.Add(Spider);
+	}
+}
+
+void USpiderBenchmarkCommandlet::DriveSpiders()
+{
+	using namespace SpiderBenchmark;
+
+	for (int32 i = 0; i < Spiders.Num(); i++)
+	{
+		ASpiderCharacter* Spider = Spiders[i];
+		FSpiderBenchmarkPath& Path = Paths[i];
+		if (!Spider || Path.Waypoints.IsEmpty()) continue;
+
+		const FVector Offset = Path.Waypoints[Path.CurrentWaypoint] - Spider->GetActorLocation();
+		if (Offset.SizeSquared2D() < FMath::Square(WaypointReachedDistance))
+			Path.CurrentWaypoint = (Path.CurrentWaypoint + 1) % Path.Waypoints.Num();
+
+		Spider->AddMovementInput(Offset.GetSafeNormal2D());
+	}
+}
+
+TSharedRef<FJsonObject> USpiderBenchmarkCommandlet::MakeSummary() const
+{
+	TArray<double> ExecuteMs, PreUpdateMs, FrameMs;
+	double ExecuteMsSum = 0, ExecuteCount = 0, SweepCount = 0, IKSolveCount = 0, IKIterationCount = 0;
+	for (const FSpiderBenchmarkFrame& Frame : Frames)
+	{
+		ExecuteMs.Add(Frame.ExecuteSeconds * 1000.0);
+		ExecuteMsSum += Frame.ExecuteSeconds * 1000.0;
+		PreUpdateMs.Add(Frame.PreUpdateSeconds * 1000.0);
+		FrameMs.Add(Frame.FrameSeconds * 1000.0);
+		ExecuteCount += Frame.ExecuteCount;
+		SweepCount += Frame.SweepCount;
+		IKSolveCount += Frame.IKSolveCount;
+		IKIterationCount += Frame.IKIterationCount;
+	}
+	const double FrameNum = FMath::Max(Frames.Num(), 1);
+
+	TSharedRef<FJsonObject> Summary = MakeShared<FJsonObject>();
+	Summary->SetNumberField(TEXT("Count"), Spiders.Num());
+	Summary->SetNumberField(TEXT("Seed"), Seed);
+	Summary->SetNumberField(TEXT("Frames"), Frames.Num());
+	Summary->SetNumberField(TEXT("DeltaTime"), DeltaTime);
+	Summary->SetStringField(TEXT("Character"), CharacterPath);
+	Summary->SetNumberField(TEXT("ExecuteMsMean"), SpiderBenchmark::Mean(ExecuteMs));
+	Summary->SetNumberField(TEXT("ExecuteMsP50"), SpiderBenchmark::Percentile(ExecuteMs, 0.5));
+	Summary->SetNumberField(TEXT("ExecuteMsP95"), SpiderBenchmark::Percentile(ExecuteMs, 0.95));
+	Summary->SetNumberField(TEXT("ExecuteMsMax"), SpiderBenchmark::Percentile(ExecuteMs, 1.0));
+	Summary->SetNumberField(TEXT("ExecuteUsPerRig"), ExecuteCount > 0 ? ExecuteMsSum * 1000.0 / ExecuteCount : 0);
+	Summary->SetNumberField(TEXT("PreUpdateMsMean"), SpiderBenchmark::Mean(PreUpdateMs));
+	Summary->SetNumberField(TEXT("PreUpdateMsP95"), SpiderBenchmark::Percentile(PreUpdateMs, 0.95));
+	Summary->SetNumberField(TEXT("FrameMsMean"), SpiderBenchmark::Mean(FrameMs));
+	Summary->SetNumberField(TEXT("FrameMsP95"), SpiderBenchmark::Percentile(FrameMs, 0.95));
+	Summary->SetNumberField(TEXT("ExecutesPerFrame"), ExecuteCount / FrameNum);
+	Summary->SetNumberField(TEXT("SweepsPerFrame"), SweepCount / FrameNum);
+	Summary->SetNumberField(TEXT("IKSolvesPerFrame"), IKSolveCount / FrameNum);
+	Summary->SetNumberField(TEXT("IKIterationsPerFrame"), IKIterationCount / FrameNum);
+	return Summary;
+}
+
+bool USpiderBenchmarkCommandlet::WriteResults(const FString& OutputPath, const TSharedRef<FJsonObject>& Summary) const
+{
+	FString Csv = TEXT("Frame,FrameMs,ExecuteMs,PreUpdateMs,Executes,Sweeps,IKSolves,IKIterations\n");
+	for (int32 i = 0; i < Frames.Num(); i++)
+	{
+		const FSpiderBenchmarkFrame& Frame = Frames[i];
+		Csv += FString::Printf(TEXT("%d,%.4f,%.4f,%.4f,%d,%d,%d,%d\n"), i, Frame.FrameSeconds * 1000.0,
+		                       Frame.ExecuteSeconds * 1000.0, Frame.PreUpdateSeconds * 1000.0,
+		                       Frame.ExecuteCount, Frame.SweepCount,
+		                       Frame.IKSolveCount, Frame.IKIterationCount);
+	}
+
+	FString Json;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Summary, JsonWriter);
+
+	const FString CsvPath = OutputPath + TEXT(".csv");
+	const FString JsonPath = OutputPath + TEXT(".json");
+	if (!FFileHelper::SaveStringToFile(Csv, *CsvPath) || !FFileHelper::SaveStringToFile(Json, *JsonPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("USpiderBenchmarkCommandlet::WriteResults -> Unable to write %s"), *OutputPath);
+		return false;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("USpiderBenchmarkCommandlet::WriteResults -> %s"), *Json);
+	return true;
+}
+
+bool USpiderBenchmarkCommandlet::CompareBaseline(const FString& BaselinePath,
+                                                 const TSharedRef<FJsonObject>& Summary) const
+{
+	FString BaselineJson;
+	TSharedPtr<FJsonObject> Baseline;
+	if (!FFileHelper::LoadFileToString(BaselineJson, *BaselinePath) ||
+		!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(BaselineJson), Baseline) || !Baseline)
+	{
+		UE_LOG(LogTemp, Error, TEXT("USpiderBenchmarkCommandlet::CompareBaseline -> Invalid baseline %s"),
+		       *BaselinePath);
+		return false;
+	}
+
+	// Timings of a different crowd or terrain can't be compared
+	if (Baseline->GetNumberField(TEXT("Count")) != Summary->GetNumberField(TEXT("Count")) ||
+		Baseline->GetNumberField(TEXT("Seed")) != Summary->GetNumberField(TEXT("Seed")))
+	{
+		UE_LOG(LogTemp, Error, TEXT("USpiderBenchmarkCommandlet::CompareBaseline -> Baseline was recorded with a different count or seed"));
+		return false;
+	}
+
+	bool bIsWithinThreshold = true;
+	for (const TCHAR* Timing : SpiderBenchmark::ComparedTimings)
+	{
+		const double BaselineValue = Baseline->GetNumberField(Timing);
+		const double CurrentValue = Summary->GetNumberField(Timing);
+		const double Change = BaselineValue > 0 ? CurrentValue / BaselineValue - 1.0 : 0;
+		const bool bIsRegressed = Change > Threshold;
+		bIsWithinThreshold &= !bIsRegressed;
+
+		UE_LOG(LogTemp, Display, TEXT("USpiderBenchmarkCommandlet::CompareBaseline -> %s: %.4f, baseline: %.4f, change: %+.1f%%%s"),
+		       Timing, CurrentValue, BaselineValue, Change * 100.0, bIsRegressed ? TEXT(" REGRESSED") : TEXT(""));
+	}
+	return bIsWithinThreshold;
+}
+#endif
@@ -6,6 +6,7 @@
 #include "CameraConfigVolume.h"
 #include "SpiderCharacter.h"
 #include "SpiderPlayerController.h"
+#include "SpiderRigStats.h"
 #include "Components/SplineComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/KismetMathLibrary.h"
@@ -30,6 +31,8 @@ FVector CalculateAxisIndependentLag(const FVector& CurrentLocation, const FVecto
 
 void ASpiderCamera::UpdateViewTargetInternal(FTViewTarget& OutVT, float DeltaTime)
 {
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(CameraUpdate);
+
 	if (!OutVT.Target) return;
 	if (!OutVT.Target.IsA<ASpiderCharacter>()) return;
 
@@ -47,7 +50,8 @@ void ASpiderCamera::UpdateViewTargetInternal(FTViewTarget& OutVT, float DeltaTim
 
 	const bool bIsGrounded = FMath::IsNearlyZero(CharacterMovement->Velocity.Z) && !CharacterMovement->IsFalling();
 
-	if (CurrentLockedVolume != nullptr && bIsGrounded)
+	UpdateZones(Character);
+	if (bIsInZone && bIsGrounded)
 		bIsLocked = true;
 
 
@@ -63,8 +67,7 @@ void ASpiderCamera::UpdateViewTargetInternal(FTViewTarget& OutVT, float DeltaTim
 			LazyDirection = FMath::VInterpTo(LazyDirection, Velocity * 200.0f, DeltaTime, 1.0f);	
 		}
 		
-		const FVector CameraLock = CurrentLockedVolume->CameraPath->FindLocationClosestToWorldLocation(
-			CameraTargetSocket - LazyDirection, ESplineCoordinateSpace::World);
+		const FVector CameraLock = CalculateRailLocation(CameraTargetSocket - LazyDirection);
 
 		FinalLocation = CameraLock;
 		FinalRotation = FRotationMatrix::MakeFromX(CameraTargetSocket - FinalLocation).Rotator();
@@ -92,12 +95,62 @@ void ASpiderCamera::UpdateViewTargetInternal(FTViewTarget& OutVT, float DeltaTim
 	if (bIsLocked)
 		PlayerController->SetControlRotation(TargetRotator + TargetFreeLookRotation);
 
-	TraceCameraCollision(Character, CameraTargetSocket, TargetLocation);
+	// The lag keeps following the unobstructed location, only the view is pulled in
+	FVector ViewLocation = TargetLocation;
+	TraceCameraCollision(Character, CameraTargetSocket, ViewLocation, DeltaTime);
 
-	OutVT.POV.Location = TargetLocation;
+	OutVT.POV.Location = ViewLocation;
 	OutVT.POV.Rotation = TargetRotator + TargetFreeLookRotation;
 }
 
+void ASpiderCamera::UpdateZones(ASpiderCharacter* Character)
+{
+	Zones.Reset();
+	if (USpiderCameraZoneSubsystem* ZoneSubsystem = GetWorld()->GetSubsystem<USpiderCameraZoneSubsystem>())
+		ZoneSubsystem->FindZones(Character->GetActorLocation(), Zones);
+
+	// Zones only blend the rails, entering and leaving depends on being inside a volume
+	const bool bWasInZone = bIsInZone;
+	bIsInZone = Zones.ContainsByPredicate([](const FSpiderCameraZone& Zone) { return Zone.bIsInside; });
+	if (bIsInZone == bWasInZone) return;
+
+	ChangeStateTimestamp = GetWorld()->GetTimeSeconds();
+	Character->bOrientRotationToMovement = bIsInZone;
+	if (!bIsInZone)
+		bIsLocked = false;
+}
+
+FVector ASpiderCamera::CalculateRailLocation(const FVector& LocationWorld)
+{
+	// Paths are only searched around where the camera was on them, forget the ones left behind
+	SplineMemories.RemoveAllSwap([this](const FCameraSplineMemory& Memory)
+	{
+		return !Zones.ContainsByPredicate([&Memory](const FSpiderCameraZone& Zone)
+		{
+			return Zone.Volume.IsValid() && Zone.Volume->GetUniqueID() == Memory.Id;
+		});
+	}, EAllowShrinking::No);
+
+	FVector RailLocation{0};
+	float TotalWeight = 0;
+	for (const FSpiderCameraZone& Zone : Zones)
+	{
+		ACameraConfigVolume* Volume = Zone.Volume.Get();
+		if (!Volume) continue;
+
+		const uint32 Id = Volume->GetUniqueID();
+		FCameraSplineMemory* Memory = SplineMemories.FindByPredicate(
+			[Id](const FCameraSplineMemory& Candidate) { return Candidate.Id == Id; });
+		if (!Memory)
+			Memory = &SplineMemories.Add_GetRef({Id, {}});
+
+		RailLocation += Volume->GetCameraPathTable().FindLocationClosestTo(LocationWorld, Memory->Cursor) *
+			Zone.Weight;
+		TotalWeight += Zone.Weight;
+	}
+	return TotalWeight > 0 ? RailLocation / TotalWeight : LocationWorld;
+}
+
 void ASpiderCamera::CalculateFreeLook(const bool& bIsGrounded)
 {
 	constexpr double Duration = 1.5f;
@@ -123,20 +176,63 @@ void ASpiderCamera::CalculateFreeLook(const bool& bIsGrounded)
 }
 
 void ASpiderCamera::TraceCameraCollision(const ASpiderCharacter* Character, const FVector& TraceOrigin, FVector& Target,
-                                         const float& TraceRadius) const
+                                         const float& DeltaTime, const float& TraceRadius)
 {
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(CameraCollision);
+
 	constexpr ECollisionChannel TraceChannel = ECC_Camera;
-	FCollisionQueryParams Params;
-	Params.AddIgnoredActor(this);
-	Params.AddIgnoredActor(Character);
-	FHitResult HitResult;
+	UWorld* World = GetWorld();
+
+	// The params only change along with the view target
+	if (CollisionCharacter != Character)
+	{
+		CollisionCharacter = Character;
+		CollisionQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(SpiderCameraCollision), false, this);
+		CollisionQueryParams.AddIgnoredActor(Character);
+		CollisionHandle = FTraceHandle();
+		CollisionPullIn = 0;
+	}
+
 	const FCollisionShape SphereCollisionShape = FCollisionShape::MakeSphere(TraceRadius);
-	GetWorld()->SweepSingleByChannel(
-		HitResult, TraceOrigin,
-		TargetLocation, FQuat::Identity,
-		TraceChannel, SphereCollisionShape, Params);
-	if (HitResult.IsValidBlockingHit())
-		Target += HitResult.Location - HitResult.TraceEnd;
+	if (bUseAsyncCollision)
+	{
+		// Use the sweep issued on the previous frame, if it isn't available keep the current pull in
+		FTraceDatum TraceDatum;
+		if (World->QueryTraceData(CollisionHandle, TraceDatum))
+		{
+			const FHitResult* HitResult = FHitResult::GetFirstBlockingHit(TraceDatum.OutHits);
+			UpdateCollisionPullIn(HitResult ? FVector::Dist(HitResult->Location, HitResult->TraceEnd) : 0.0f,
+			                      DeltaTime);
+		}
+		CollisionHandle = World->AsyncSweepByChannel(
+			EAsyncTraceType::Single, TraceOrigin, Target, FQuat::Identity,
+			TraceChannel, SphereCollisionShape, CollisionQueryParams);
+	}
+	else
+	{
+		FHitResult HitResult;
+		World->SweepSingleByChannel(
+			HitResult, TraceOrigin,
+			Target, FQuat::Identity,
+			TraceChannel, SphereCollisionShape, CollisionQueryParams);
+		UpdateCollisionPullIn(HitResult.IsValidBlockingHit() ? FVector::Dist(HitResult.Location, HitResult.TraceEnd)
+			                      : 0.0f, DeltaTime);
+	}
+
+	// Pull the camera towards the target along the current sweep, it barely moved since the last one
+	const FVector TraceVector = Target - TraceOrigin;
+	const float TraceLength = TraceVector.Size();
+	if (TraceLength > UE_KINDA_SMALL_NUMBER)
+		Target -= TraceVector / TraceLength * FMath::Min(CollisionPullIn, TraceLength);
+}
+
+void ASpiderCamera::UpdateCollisionPullIn(const float& DesiredPullIn, const float& DeltaTime)
+{
+	// Obstacles pull the camera in fast, it only moves back out slowly once it is clearly too far in
+	if (DesiredPullIn > CollisionPullIn)
+		CollisionPullIn = FMath::FInterpTo(CollisionPullIn, DesiredPullIn, DeltaTime, CollisionPullInSpeed);
+	else if (DesiredPullIn <= 0 || CollisionPullIn - DesiredPullIn > CollisionHysteresis)
+		CollisionPullIn = FMath::FInterpTo(CollisionPullIn, DesiredPullIn, DeltaTime, CollisionReleaseSpeed);
 }
 
 void ASpiderCamera::CalculateLagSpeeds(FVector& LagSpeeds, float& RotSpeed) const
@@ -157,53 +253,18 @@ void ASpiderCamera::CalculateLagSpeeds(FVector& LagSpeeds, float& RotSpeed) cons
 
 void ASpiderCamera::OnPossess(APawn* NewPawn)
 {
-	if (NewPawn)
-	{
-		NewPawn->OnActorBeginOverlap.AddDynamic(this, &ASpiderCamera::OnBeginOverlap);
-		NewPawn->OnActorEndOverlap.AddDynamic(this, &ASpiderCamera::OnEndOverlap);
-		PreviouslyPossessedPawn = NewPawn;
-		TargetLocation = NewPawn->GetActorLocation();
-	}
-	else if (PreviouslyPossessedPawn)
+	// The zones of the new pawn are found on the next update, hand the previous one back as it was
+	if (PreviouslyPossessedPawn && IsValid(PreviouslyPossessedPawn) && bIsInZone)
 	{
-		if (IsValid(PreviouslyPossessedPawn))
-		{
-			PreviouslyPossessedPawn->OnActorBeginOverlap.RemoveDynamic(this, &ASpiderCamera::OnBeginOverlap);
-			PreviouslyPossessedPawn->OnActorEndOverlap.RemoveDynamic(this, &ASpiderCamera::OnEndOverlap);
-		}
-		PreviouslyPossessedPawn = nullptr;
+		if (const auto Character = Cast<ASpiderCharacter>(PreviouslyPossessedPawn))
+			Character->bOrientRotationToMovement = false;
 	}
-}
+	bIsInZone = false;
+	bIsLocked = false;
+	Zones.Reset();
+	SplineMemories.Reset();
 
-void ASpiderCamera::OnBeginOverlap(AActor* OverlappedActor, AActor* OtherActor)
-{
-	if (!OtherActor->IsA<ACameraConfigVolume>()) return;
-	const auto CameraConfig = Cast<ACameraConfigVolume>(OtherActor);
-	if (!IsValid(CameraConfig)) return;
-	CurrentLockedVolume = CameraConfig;
-	ChangeStateTimestamp = GetWorld()->GetTimeSeconds();
-
-
-	const auto Character = Cast<ASpiderCharacter>(OverlappedActor);
-	Character->bOrientRotationToMovement = true;
-	OverlapCounter++;
-	UE_LOG(LogTemp, Display, TEXT("ASpiderCamera::OnBeginOverlap %d"), OverlapCounter);
-}
-
-void ASpiderCamera::OnEndOverlap(AActor* OverlappedActor, AActor* OtherActor)
-{
-	if (!OtherActor->IsA<ACameraConfigVolume>()) return;
-	if (const auto CameraConfig = Cast<ACameraConfigVolume>(OtherActor); !IsValid(CameraConfig)) return;
-
-	UE_LOG(LogTemp, Display, TEXT("ASpiderCamera::OnEndOverlap %d"), OverlapCounter);
-
-	if (CurrentLockedVolume && !(--OverlapCounter))
-	{
-		ChangeStateTimestamp = GetWorld()->GetTimeSeconds();
-
-		const auto Character = Cast<ASpiderCharacter>(OverlappedActor);
-		Character->bOrientRotationToMovement = false;
-		CurrentLockedVolume = nullptr;
-		bIsLocked = false;
-	}
+	PreviouslyPossessedPawn = NewPawn;
+	if (NewPawn)
+		TargetLocation = NewPawn->GetActorLocation();
 }
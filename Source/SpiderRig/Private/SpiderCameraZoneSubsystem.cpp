@@ -0,0 +1,190 @@
+#include "SpiderCameraZoneSubsystem.h"
+
+#include "CameraConfigVolume.h"
+#include "SpiderRigStats.h"
+#include "Algo/Sort.h"
+#include "Engine/World.h"
+
+namespace SpiderCameraZones
+{
+	// Volumes per leaf, a few box tests are cheaper than going further down
+	constexpr int32 LeafSize = 4;
+}
+
+void USpiderCameraZoneSubsystem::Deinitialize()
+{
+	Volumes.Empty();
+	Entries.Empty();
+	Nodes.Empty();
+	Super::Deinitialize();
+}
+
+bool USpiderCameraZoneSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USpiderCameraZoneSubsystem::RegisterVolume(ACameraConfigVolume* Volume)
+{
+	if (!Volume || Volumes.Contains(Volume)) return;
+	Volumes.Add(Volume);
+	bIsDirty = true;
+}
+
+void USpiderCameraZoneSubsystem::UnregisterVolume(ACameraConfigVolume* Volume)
+{
+	if (Volumes.Remove(Volume) > 0)
+		bIsDirty = true;
+}
+
+void USpiderCameraZoneSubsystem::Rebuild()
+{
+	LLM_SCOPE_BYTAG(SpiderRig);
+	bIsDirty = false;
+
+	Entries.Reset();
+	Volumes.RemoveAllSwap([](const TWeakObjectPtr<ACameraConfigVolume>& Volume) { return !Volume.IsValid(); });
+	for (const TWeakObjectPtr<ACameraConfigVolume>& Volume : Volumes)
+	{
+		// Expanded by the blend distance, the zone is found as soon as it starts blending in
+		const FBox Bounds = Volume->GetComponentsBoundingBox().ExpandBy(Volume->BlendDistance);
+		Entries.Add({Volume, Bounds, Volume->Priority, Volume->BlendDistance});
+	}
+
+	Nodes.Reset();
+	if (Entries.IsEmpty()) return;
+	Nodes.AddDefaulted();
+	BuildNode(0, 0, Entries.Num());
+}
+
+void USpiderCameraZoneSubsystem::BuildNode(const int32& NodeIndex, const int32& First, const int32& Count)
+{
+	FBox Bounds(ForceInit);
+	FBox CenterBounds(ForceInit);
+	for (int32 i = First; i < First + Count; i++)
+	{
+		Bounds += Entries[i].Bounds;
+		CenterBounds += Entries[i].Bounds.GetCenter();
+	}
+	Nodes[NodeIndex].Bounds = Bounds;
+
+	if (Count <= SpiderCameraZones::LeafSize)
+	{
+		Nodes[NodeIndex].First = First;
+		Nodes[NodeIndex].Count = Count;
+		return;
+	}
+
+	// Split at the median along the axis the volumes are spread the most on
+	const FVector Extent = CenterBounds.GetExtent();
+	const int32 Axis = Extent.X >= Extent.Y && Extent.X >= Extent.Z ? 0 : Extent.Y >= Extent.Z ? 1 : 2;
+	const int32 LeftCount = Count / 2;
+	TArrayView<FEntry> Range(Entries.GetData() + First, Count);
+	Algo::Sort(Range, [Axis](const FEntry& A, const FEntry& B)
+	{
+		return A.Bounds.GetCenter()[Axis] < B.Bounds.GetCenter()[Axis];
+	});
+
+	// Both children are added before going down, so they stay next to each other
+	const int32 LeftIndex = Nodes.AddDefaulted(2);
+	Nodes[NodeIndex].First = LeftIndex;
+	Nodes[NodeIndex].Count = 0;
+	BuildNode(LeftIndex, First, LeftCount);
+	BuildNode(LeftIndex + 1, First + LeftCount, Count - LeftCount);
+}
+
+void USpiderCameraZoneSubsystem::CollectEntries(const FVector& LocationWorld,
+                                                TArray<int32, TInlineAllocator<8>>& OutEntries) const
+{
+	if (Nodes.IsEmpty()) return;
+
+	TArray<int32, TInlineAllocator<32>> Stack;
+	Stack.Add(0);
+	while (!Stack.IsEmpty())
+	{
+		const FNode& Node = Nodes[Stack.Pop(EAllowShrinking::No)];
+		if (!Node.Bounds.IsInsideOrOn(LocationWorld)) continue;
+
+		if (Node.Count == 0)
+		{
+			Stack.Add(Node.First);
+			Stack.Add(Node.First + 1);
+			continue;
+		}
+
+		for (int32 i = Node.First; i < Node.First + Node.Count; i++)
+		{
+			if (Entries[i].Bounds.IsInsideOrOn(LocationWorld))
+				OutEntries.Add(i);
+		}
+	}
+}
+
+void USpiderCameraZoneSubsystem::FindZones(const FVector& LocationWorld, TArray<FSpiderCameraZone>& OutZones)
+{
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(CameraZones);
+	OutZones.Reset();
+	if (bIsDirty)
+		Rebuild();
+
+	TArray<int32, TInlineAllocator<8>> Candidates;
+	CollectEntries(LocationWorld, Candidates);
+	if (Candidates.IsEmpty()) return;
+
+	// The bounds only narrowed it down, the brush decides how far the location is from the volume
+	TArray<TPair<int32, float>, TInlineAllocator<8>> Blends;
+	for (const int32 EntryIndex : Candidates)
+	{
+		const FEntry& Entry = Entries[EntryIndex];
+		const ACameraConfigVolume* Volume = Entry.Volume.Get();
+		if (!Volume) continue;
+
+		float Distance = 0;
+		if (!Volume->EncompassesPoint(LocationWorld, Entry.BlendDistance, &Distance)) continue;
+
+		const float BlendWeight = Distance <= 0 ? 1.0f : 1.0f - Distance / FMath::Max(Entry.BlendDistance, 1.0f);
+		if (BlendWeight <= 0) continue;
+		Blends.Add({EntryIndex, BlendWeight});
+	}
+
+	Blends.Sort([this](const TPair<int32, float>& A, const TPair<int32, float>& B)
+	{
+		return Entries[A.Key].Priority > Entries[B.Key].Priority;
+	});
+
+	// Each priority takes the share of the weight left over by the higher ones, as much as its deepest zone
+	// is blended in, and splits it among its zones
+	float RemainingWeight = 1.0f;
+	float TotalWeight = 0.0f;
+	for (int32 GroupStart = 0; GroupStart < Blends.Num() && RemainingWeight > 0;)
+	{
+		const int32 Priority = Entries[Blends[GroupStart].Key].Priority;
+		int32 GroupEnd = GroupStart;
+		float GroupMaxWeight = 0.0f;
+		float GroupSumWeight = 0.0f;
+		for (; GroupEnd < Blends.Num() && Entries[Blends[GroupEnd].Key].Priority == Priority; GroupEnd++)
+		{
+			GroupMaxWeight = FMath::Max(GroupMaxWeight, Blends[GroupEnd].Value);
+			GroupSumWeight += Blends[GroupEnd].Value;
+		}
+
+		const float GroupWeight = RemainingWeight * GroupMaxWeight;
+		for (int32 i = GroupStart; i < GroupEnd; i++)
+		{
+			const float Weight = GroupWeight * Blends[i].Value / GroupSumWeight;
+			OutZones.Add({Entries[Blends[i].Key].Volume, Weight, Blends[i].Value >= 1.0f});
+			TotalWeight += Weight;
+		}
+		RemainingWeight -= GroupWeight;
+		GroupStart = GroupEnd;
+	}
+
+	// Only rails are blended, the weight left over by the lowest priority is spread over them as well
+	if (TotalWeight <= 0)
+	{
+		OutZones.Reset();
+		return;
+	}
+	for (FSpiderCameraZone& Zone : OutZones)
+		Zone.Weight /= TotalWeight;
+}
@@ -1,10 +1,14 @@
 ﻿#include "SpiderCharacter.h"
 
 #include "SpiderEffectsComponent.h"
+#include "SpiderMeshComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Net/UnrealNetwork.h"
 
-ASpiderCharacter::ASpiderCharacter()
+ASpiderCharacter::ASpiderCharacter(const FObjectInitializer& ObjectInitializer)
+	// The mesh ticks within the animation budget, which in turn throttles the rig
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USpiderMeshComponent>(ACharacter::MeshComponentName))
 {
 	const auto Movement = GetCharacterMovement();
 	Movement->MaxWalkSpeed = 160;
@@ -21,6 +25,17 @@ ASpiderCharacter::ASpiderCharacter()
 	SpiderEffectsComp = CreateDefaultSubobject<USpiderEffectsComponent>(TEXT("SpiderEffectsComponent"));
 }
 
+void ASpiderCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME_CONDITION(ASpiderCharacter, GaitState, COND_SimulatedOnly);
+}
+
+void ASpiderCharacter::OnRep_GaitState()
+{
+	GaitStateSerial++;
+}
+
 void ASpiderCharacter::ApplyCharacterMovement(const FVector2d& Movement)
 {
 	const auto CharMovement = GetCharacterMovement();
@@ -35,7 +50,8 @@ void ASpiderCharacter::ApplyCharacterMovement(const FVector2d& Movement)
 		                       : FRotator(0, GetControlRotation().Yaw, 0);
 	ActorMovementDirection = UKismetMathLibrary::RLerp(ActorMovementDirection, OrientRot,
 	                                                   GetWorld()->GetDeltaSeconds() * 10.0f, true);
-	SetActorRotation(ActorMovementDirection);
+	if (!ActorMovementDirection.Equals(GetActorRotation()))
+		SetActorRotation(ActorMovementDirection);
 }
 
 void ASpiderCharacter::ApplyCameraMovement(const FVector2d& Movement)
@@ -0,0 +1,112 @@
+#include "SpiderCrowdSubsystem.h"
+
+#include "SpiderRig.h"
+#include "SpiderRigStats.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+#include <atomic>
+
+static TAutoConsoleVariable<int32> CVarSpiderCrowdParallel(
+	TEXT("spiderrig.Crowd.Parallel"),
+	1,
+	TEXT("Solve the spider crowd on the worker threads, 0 solves every rig on the game thread."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarSpiderCrowdMinBatchSize(
+	TEXT("spiderrig.Crowd.MinBatchSize"),
+	4,
+	TEXT("Minimum number of spider rigs solved by a single worker task."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorld SpiderCrowdReportCommand(
+	TEXT("spiderrig.Crowd.Report"),
+	TEXT("Print how long the spider crowd takes to solve and how well it scales over the worker threads."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](const UWorld* World)
+	{
+		if (!World) return;
+		const USpiderCrowdSubsystem* Crowd = World->GetSubsystem<USpiderCrowdSubsystem>();
+		if (!Crowd) return;
+
+		// Serial time over wall time is the speed-up we got out of the workers
+		const FSpiderCrowdStats& Stats = Crowd->GetStats();
+		const double SpeedUp = Stats.AverageWallSeconds > 0 ? Stats.AverageRigSeconds / Stats.AverageWallSeconds : 0;
+		const int32 Threads = FMath::Max(Stats.WorkerCount + 1, 1);
+
+		UE_LOG(LogTemp, Display,
+		       TEXT("USpiderCrowdSubsystem -> rigs: %d, threads: %d, wall: %.3f ms, serial: %.3f ms, speed-up: %.2fx, per thread efficiency: %.0f%%"),
+		       Stats.RigCount, Threads, Stats.AverageWallSeconds * 1000.0, Stats.AverageRigSeconds * 1000.0,
+		       SpeedUp, SpeedUp / Threads * 100.0);
+	}));
+
+void USpiderCrowdSubsystem::RegisterRig(USpiderRig* Rig)
+{
+	LLM_SCOPE_BYTAG(SpiderRig);
+	Rigs.AddUnique(Rig);
+}
+
+void USpiderCrowdSubsystem::UnregisterRig(USpiderRig* Rig)
+{
+	Rigs.RemoveSwap(Rig);
+}
+
+void USpiderCrowdSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Collect the rigs which gathered a frame since the last tick
+	PendingRigs.Reset();
+	for (int32 i = Rigs.Num() - 1; i >= 0; i--)
+	{
+		USpiderRig* Rig = Rigs[i].Get();
+		if (!Rig)
+		{
+			Rigs.RemoveAtSwap(i, 1, EAllowShrinking::No);
+			continue;
+		}
+		if (Rig->HasPendingCrowdFrame())
+			PendingRigs.Add(Rig);
+	}
+
+	Stats.RigCount = PendingRigs.Num();
+	if (PendingRigs.IsEmpty()) return;
+
+	// Every rig only touches its own hierarchy and solver, so they can run side by side
+	std::atomic<uint64> RigCycles{0};
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	ParallelFor(
+		TEXT("SpiderCrowd.Solve"),
+		PendingRigs.Num(),
+		FMath::Max(CVarSpiderCrowdMinBatchSize.GetValueOnGameThread(), 1),
+		[this, &RigCycles](const int32 Index)
+		{
+			const uint64 RigStartCycles = FPlatformTime::Cycles64();
+			PendingRigs[Index]->SolveCrowdFrame();
+			RigCycles += FPlatformTime::Cycles64() - RigStartCycles;
+		},
+		CVarSpiderCrowdParallel.GetValueOnGameThread() ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread
+	);
+
+	Stats.WallSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+	Stats.RigSeconds = FPlatformTime::ToSeconds64(RigCycles.load());
+	Stats.WorkerCount = CVarSpiderCrowdParallel.GetValueOnGameThread()
+		                    ? FTaskGraphInterface::Get().GetNumWorkerThreads()
+		                    : 0;
+
+	// Smooth the timings so the report isn't dominated by a single frame
+	constexpr double Smoothing = 0.05;
+	Stats.AverageWallSeconds = FMath::Lerp(Stats.AverageWallSeconds, Stats.WallSeconds, Smoothing);
+	Stats.AverageRigSeconds = FMath::Lerp(Stats.AverageRigSeconds, Stats.RigSeconds, Smoothing);
+}
+
+TStatId USpiderCrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USpiderCrowdSubsystem, STATGROUP_Tickables);
+}
+
+bool USpiderCrowdSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,210 @@
+#include "SpiderEffectBudgetSubsystem.h"
+
+#include "SpiderRigStats.h"
+#include "NiagaraComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarSpiderEffectsMaxSpawnsPerFrame(
+	TEXT("spiderrig.Effects.MaxSpawnsPerFrame"),
+	16,
+	TEXT("Most landing puffs spider effects start in a single frame."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarSpiderEffectsMaxLive(
+	TEXT("spiderrig.Effects.MaxLive"),
+	64,
+	TEXT("Most landing puffs of every spider playing at once."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarSpiderEffectsMergeRadius(
+	TEXT("spiderrig.Effects.MergeRadius"),
+	60.0f,
+	TEXT("Landings closer than this in world units are merged into a single bigger puff, 0 disables merging."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarSpiderEffectsMinSignificance(
+	TEXT("spiderrig.Effects.MinSignificance"),
+	0.005f,
+	TEXT("Landings with a jump impact over view distance below this are dropped."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarSpiderEffectsCullOffscreen(
+	TEXT("spiderrig.Effects.CullOffscreen"),
+	1,
+	TEXT("Drop landings outside the field of view of every player camera."),
+	ECVF_Scalability);
+
+namespace SpiderEffectBudget
+{
+	// Views closer than this all count as this close, so a landing under the camera doesn't win everything
+	constexpr float MinViewDistance = 100.0f;
+
+	// The field of view is widened a bit, puffs are larger than their location
+	constexpr float ViewAngleMargin = 1.2f;
+
+	// A merged landing adds part of the other impact, so a swarm doesn't make one gigantic puff
+	constexpr float MergedImpactRatio = 0.5f;
+
+	struct FView
+	{
+		FVector Location{0};
+		FVector Direction{0};
+		float CosHalfFieldOfView{0};
+	};
+}
+
+void USpiderEffectBudgetSubsystem::QueueLandings(USpiderEffectsComponent* Effects,
+                                                 const TArray<FSpiderLandingRequest>& Requests)
+{
+	LLM_SCOPE_BYTAG(SpiderRig);
+	PendingLandings.Reserve(PendingLandings.Num() + Requests.Num());
+	for (const FSpiderLandingRequest& Request : Requests)
+		PendingLandings.Add({Request, Effects, 0});
+}
+
+void USpiderEffectBudgetSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	if (PendingLandings.IsEmpty()) return;
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(EffectBudget);
+	LLM_SCOPE_BYTAG(SpiderRig);
+
+	SPIDERRIG_INC_COUNTER_BY(EffectRequests, PendingLandings.Num());
+	MergeLandings();
+	PendingLandings.Reset();
+	RankLandings();
+
+	// Play the most significant landings within both caps, the rest of the frame is dropped
+	const int32 Budget = FMath::Min(CVarSpiderEffectsMaxSpawnsPerFrame.GetValueOnGameThread(),
+	                                CVarSpiderEffectsMaxLive.GetValueOnGameThread() - CountLivePuffs());
+	int32 Played = 0;
+	for (const FSpiderPendingLanding& Landing : MergedLandings)
+	{
+		if (Played >= Budget) break;
+		USpiderEffectsComponent* Effects = Landing.Effects.Get();
+		if (!Effects) continue;
+
+		if (UNiagaraComponent* Puff = Effects->PlayPuff(Landing.Request))
+		{
+			LivePuffs.AddUnique(Puff);
+			Played++;
+		}
+	}
+	SPIDERRIG_INC_COUNTER_BY(EffectsDropped, MergedLandings.Num() - Played);
+	MergedLandings.Reset();
+}
+
+void USpiderEffectBudgetSubsystem::MergeLandings()
+{
+	// Strongest landings first, so they keep their location and absorb the weaker ones around them
+	PendingLandings.Sort([](const FSpiderPendingLanding& A, const FSpiderPendingLanding& B)
+	{
+		return A.Request.JumpImpact > B.Request.JumpImpact;
+	});
+
+	const float MergeRadius = CVarSpiderEffectsMergeRadius.GetValueOnGameThread();
+	if (MergeRadius <= 0)
+	{
+		MergedLandings = PendingLandings;
+		return;
+	}
+
+	// Landings are only merged within the same cell, cheap and close enough for puffs
+	MergeCells.Reset();
+	MergedLandings.Reset(PendingLandings.Num());
+	for (const FSpiderPendingLanding& Landing : PendingLandings)
+	{
+		const FVector& Location = Landing.Request.LocationWorld;
+		const FIntVector Cell(
+			FMath::FloorToInt32(Location.X / MergeRadius),
+			FMath::FloorToInt32(Location.Y / MergeRadius),
+			FMath::FloorToInt32(Location.Z / MergeRadius));
+
+		if (const int32* Merged = MergeCells.Find(Cell))
+		{
+			MergedLandings[*Merged].Request.JumpImpact += Landing.Request.JumpImpact *
+				SpiderEffectBudget::MergedImpactRatio;
+			continue;
+		}
+		MergeCells.Add(Cell, MergedLandings.Add(Landing));
+	}
+}
+
+void USpiderEffectBudgetSubsystem::RankLandings()
+{
+	using namespace SpiderEffectBudget;
+
+	TArray<FView, TInlineAllocator<4>> Views;
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		if (!PlayerController || !PlayerController->PlayerCameraManager) continue;
+
+		const APlayerCameraManager* CameraManager = PlayerController->PlayerCameraManager;
+		const float HalfFieldOfView = FMath::Clamp(CameraManager->GetFOVAngle() * 0.5f * ViewAngleMargin, 1.0f, 89.0f);
+		Views.Add({
+			CameraManager->GetCameraLocation(),
+			CameraManager->GetCameraRotation().Vector(),
+			FMath::Cos(FMath::DegreesToRadians(HalfFieldOfView))
+		});
+	}
+
+	// Without any view (e.g. dedicated servers) nothing would be seen anyway
+	if (Views.IsEmpty())
+	{
+		MergedLandings.Reset();
+		return;
+	}
+
+	const bool bCullOffscreen = CVarSpiderEffectsCullOffscreen.GetValueOnGameThread() != 0;
+	const float MinSignificance = CVarSpiderEffectsMinSignificance.GetValueOnGameThread();
+	for (FSpiderPendingLanding& Landing : MergedLandings)
+	{
+		// The closest view the landing is visible from decides how much it matters
+		float ClosestDistance = TNumericLimits<float>::Max();
+		for (const FView& View : Views)
+		{
+			const FVector Offset = Landing.Request.LocationWorld - View.Location;
+			const float Distance = Offset.Size();
+			const bool bIsOnScreen = Distance <= MinViewDistance ||
+				FVector::DotProduct(Offset / Distance, View.Direction) >= View.CosHalfFieldOfView;
+			if (bCullOffscreen && !bIsOnScreen) continue;
+			ClosestDistance = FMath::Min(ClosestDistance, Distance);
+		}
+
+		Landing.Significance = ClosestDistance < TNumericLimits<float>::Max()
+			                       ? Landing.Request.JumpImpact / FMath::Max(ClosestDistance, MinViewDistance)
+			                       : 0.0f;
+	}
+
+	MergedLandings.RemoveAllSwap([MinSignificance](const FSpiderPendingLanding& Landing)
+	{
+		return Landing.Significance <= 0.0f || Landing.Significance < MinSignificance;
+	}, EAllowShrinking::No);
+	MergedLandings.Sort([](const FSpiderPendingLanding& A, const FSpiderPendingLanding& B)
+	{
+		return A.Significance > B.Significance;
+	});
+}
+
+int32 USpiderEffectBudgetSubsystem::CountLivePuffs()
+{
+	LivePuffs.RemoveAllSwap([](const TWeakObjectPtr<UNiagaraComponent>& Puff)
+	{
+		return !Puff.IsValid() || !Puff->IsActive();
+	}, EAllowShrinking::No);
+	return LivePuffs.Num();
+}
+
+TStatId USpiderEffectBudgetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USpiderEffectBudgetSubsystem, STATGROUP_Tickables);
+}
+
+bool USpiderEffectBudgetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -2,8 +2,9 @@
 
 
 #include "SpiderEffectsComponent.h"
+#include "SpiderEffectBudgetSubsystem.h"
+#include "SpiderRigStats.h"
 #include "NiagaraComponent.h"
-#include "NiagaraFunctionLibrary.h"
 
 
 USpiderEffectsComponent::USpiderEffectsComponent()
@@ -11,18 +12,69 @@ USpiderEffectsComponent::USpiderEffectsComponent()
 	PrimaryComponentTick.bCanEverTick = false;
 }
 
-void USpiderEffectsComponent::NotifyFallenAfterJump(const FVector& WorldLocation, const float& JumpImpact,
-                                                    const bool& bIsLeg)
+void USpiderEffectsComponent::OnUnregister()
 {
-	AsyncTask(ENamedThreads::GameThread, [this, WorldLocation, JumpImpact, bIsLeg]()
+	for (UNiagaraComponent* Puff : PuffPool)
 	{
-		if (PuffEffect)
-		{
-			UNiagaraComponent* Effect = UNiagaraFunctionLibrary::SpawnSystemAttached(
-				PuffEffect, this,
-				NAME_None, WorldLocation, FRotator(0.f),
-				EAttachLocation::Type::KeepWorldPosition, true);
-			Effect->SetVariableVec2(FName("ScaleFactor"), FVector2D(FMath::Clamp(JumpImpact / 4.0f, 10.0f, 40.0f)));
-		}
-	});
+		if (Puff)
+			Puff->DestroyComponent();
+	}
+	PuffPool.Reset();
+	NextPuff = 0;
+
+	Super::OnUnregister();
+}
+
+UNiagaraComponent* USpiderEffectsComponent::AcquirePuff()
+{
+	// Components are only created until the pool is full, afterwards they are restarted
+	if (PuffPool.Num() < FMath::Max(PuffPoolSize, 1))
+	{
+		UNiagaraComponent* Puff = NewObject<UNiagaraComponent>(GetOwner(), NAME_None, RF_Transient);
+		Puff->SetAutoActivate(false);
+		Puff->SetAutoDestroy(false);
+		Puff->SetAsset(PuffEffect);
+		Puff->SetupAttachment(this);
+		Puff->RegisterComponent();
+		PuffPool.Add(Puff);
+		return Puff;
+	}
+
+	UNiagaraComponent* Puff = PuffPool[NextPuff];
+	NextPuff = (NextPuff + 1) % PuffPool.Num();
+	return Puff;
+}
+
+void USpiderEffectsComponent::NotifyFallenAfterJump(const TArray<FSpiderLandingRequest>& Requests)
+{
+	check(IsInGameThread());
+	if (!PuffEffect) return;
+
+	// The budget plays them at the end of the frame, along with the landings of every other spider
+	if (USpiderEffectBudgetSubsystem* Budget = GetWorld()->GetSubsystem<USpiderEffectBudgetSubsystem>())
+	{
+		Budget->QueueLandings(this, Requests);
+		return;
+	}
+
+	for (const FSpiderLandingRequest& Request : Requests)
+		PlayPuff(Request);
+}
+
+UNiagaraComponent* USpiderEffectsComponent::PlayPuff(const FSpiderLandingRequest& Request)
+{
+	if (!PuffEffect) return nullptr;
+
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(EffectSpawn);
+	LLM_SCOPE_BYTAG(SpiderRig);
+	UNiagaraComponent* Puff = AcquirePuff();
+	if (!Puff) return nullptr;
+
+	SPIDERRIG_INC_COUNTER_BY(EffectSpawns, 1);
+	if (Puff->GetAsset() != PuffEffect)
+		Puff->SetAsset(PuffEffect);
+	Puff->SetWorldLocation(Request.LocationWorld);
+	Puff->SetVariableVec2(FName("ScaleFactor"), FVector2D(FMath::Clamp(Request.JumpImpact / 4.0f, 10.0f, 40.0f)));
+	Puff->Activate(true);
+	return Puff;
 }
@@ -0,0 +1,116 @@
+#include "SpiderFootholdBakeCommandlet.h"
+
+#include "SpiderFootholdMap.h"
+#include "Engine/Level.h"
+#include "Engine/LevelBounds.h"
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+
+USpiderFootholdBakeCommandlet::USpiderFootholdBakeCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Bakes the walkable static collision of a level into a foothold map.");
+	HelpUsage = TEXT("-run=SpiderFootholdBake -Map=<level package> -Spacing=25 -Bounds=<min,max> -Output=<package>");
+}
+
+int32 USpiderFootholdBakeCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString MapPackageName;
+	FString OutputPackageName;
+	FString BoundsString;
+	FSpiderFootholdBakeSettings Settings;
+
+	FParse::Value(*Params, TEXT("Map="), MapPackageName);
+	FParse::Value(*Params, TEXT("Output="), OutputPackageName);
+	FParse::Value(*Params, TEXT("Bounds="), BoundsString);
+	FParse::Value(*Params, TEXT("Spacing="), Settings.SampleSpacing);
+	FParse::Value(*Params, TEXT("CellSize="), Settings.CellSize);
+	FParse::Value(*Params, TEXT("MaxSlope="), Settings.MaxSlopeDegrees);
+	FParse::Value(*Params, TEXT("LedgeHeight="), Settings.LedgeHeight);
+	FParse::Value(*Params, TEXT("MaxLayers="), Settings.MaxLayers);
+	FParse::Value(*Params, TEXT("MaxBlocking="), Settings.MaxBlockingSamples);
+
+	Settings.MaxLayers = FMath::Clamp(Settings.MaxLayers, 1, 64);
+	Settings.MaxBlockingSamples = FMath::Clamp(Settings.MaxBlockingSamples, 0, 1024);
+	if (OutputPackageName.IsEmpty())
+		OutputPackageName = USpiderFootholdMap::GetMapPackageName(MapPackageName);
+
+	UPackage* MapPackage = LoadPackage(nullptr, *MapPackageName, LOAD_None);
+	UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+	if (!World)
+	{
+		UE_LOG(LogTemp, Error, TEXT("USpiderFootholdBakeCommandlet::Main -> Invalid map %s"), *MapPackageName);
+		return 1;
+	}
+
+	// Only the collision is needed, no physics simulation, navigation or audio
+	World->AddToRoot();
+	World->WorldType = EWorldType::Editor;
+	if (!World->bIsWorldInitialized)
+	{
+		UWorld::InitializationValues InitializationValues;
+		InitializationValues.ShouldSimulatePhysics(false)
+		                    .EnableTraceCollision(true)
+		                    .CreateNavigation(false)
+		                    .CreateAISystem(false)
+		                    .AllowAudioPlayback(false)
+		                    .RequiresHitProxies(false);
+		World->InitWorld(InitializationValues);
+	}
+	World->UpdateWorldComponents(true, false);
+
+	if (BoundsString.IsEmpty())
+	{
+		Settings.Bounds = ALevelBounds::CalculateLevelBounds(World->PersistentLevel);
+	}
+	else
+	{
+		TArray<FString> Values;
+		BoundsString.ParseIntoArray(Values, TEXT(","));
+		if (Values.Num() != 6)
+		{
+			UE_LOG(LogTemp, Error, TEXT("USpiderFootholdBakeCommandlet::Main -> Invalid bounds %s"), *BoundsString);
+			World->RemoveFromRoot();
+			return 1;
+		}
+		Settings.Bounds = FBox(
+			FVector(FCString::Atod(*Values[0]), FCString::Atod(*Values[1]), FCString::Atod(*Values[2])),
+			FVector(FCString::Atod(*Values[3]), FCString::Atod(*Values[4]), FCString::Atod(*Values[5])));
+	}
+
+	const FString OutputName = FPackageName::GetShortName(OutputPackageName);
+	UPackage* OutputPackage = CreatePackage(*OutputPackageName);
+	USpiderFootholdMap* Map = NewObject<USpiderFootholdMap>(OutputPackage, *OutputName, RF_Public | RF_Standalone);
+
+	const double StartSeconds = FPlatformTime::Seconds();
+	Map->Bake(World, Settings);
+	UE_LOG(LogTemp, Display, TEXT("USpiderFootholdBakeCommandlet::Main -> %d footholds over %s in %.2fs"),
+	       Map->GetSampleCount(), *Settings.Bounds.ToString(), FPlatformTime::Seconds() - StartSeconds);
+
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+
+	FSavePackageArgs SaveArgs;
+	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+	const FString Filename = FPackageName::LongPackageNameToFilename(OutputPackageName,
+	                                                                 FPackageName::GetAssetPackageExtension());
+	if (!UPackage::SavePackage(OutputPackage, Map, *Filename, SaveArgs))
+	{
+		UE_LOG(LogTemp, Error, TEXT("USpiderFootholdBakeCommandlet::Main -> Unable to save %s"), *Filename);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("USpiderFootholdBakeCommandlet::Main -> Saved %s"), *Filename);
+	return 0;
+#else
+	UE_LOG(LogTemp, Error, TEXT("USpiderFootholdBakeCommandlet::Main -> Footholds can only be baked in the editor"));
+	return 1;
+#endif
+}
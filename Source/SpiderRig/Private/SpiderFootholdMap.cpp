@@ -0,0 +1,277 @@
+#include "SpiderFootholdMap.h"
+
+#include "SpiderRigStats.h"
+#include "Algo/BinarySearch.h"
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+
+namespace SpiderFoothold
+{
+	// Cell coordinates are packed in 21 bits per axis, biased so negative cells sort before positive ones
+	constexpr int32 CellBits = 21;
+	constexpr int64 CellBias = 1 << (CellBits - 1);
+	constexpr uint64 CellMask = (1ull << CellBits) - 1;
+
+	// A sweep spanning more cells than this is left to the physics scene
+	constexpr int32 MaxQueryCells = 27;
+
+	// Bake traces restart this far past a surface, a hair below it the next trace would start penetrating it
+	constexpr float SurfaceOffset = 2.0f;
+
+	uint64 PackCellKey(const int64& X, const int64& Y, const int64& Z)
+	{
+		return (static_cast<uint64>(X + CellBias) & CellMask) << (CellBits * 2) |
+			(static_cast<uint64>(Y + CellBias) & CellMask) << CellBits |
+			(static_cast<uint64>(Z + CellBias) & CellMask);
+	}
+}
+
+void USpiderFootholdMap::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+	LLM_SCOPE_BYTAG(SpiderRig);
+
+	Ar << Bounds;
+	Ar << SampleSpacing;
+	Ar << CellSize;
+	CellKeys.BulkSerialize(Ar);
+	CellStarts.BulkSerialize(Ar);
+	Positions.BulkSerialize(Ar);
+	Normals.BulkSerialize(Ar);
+	Flags.BulkSerialize(Ar);
+}
+
+void USpiderFootholdMap::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(
+		CellKeys.GetAllocatedSize() + CellStarts.GetAllocatedSize() + Positions.GetAllocatedSize() +
+		Normals.GetAllocatedSize() + Flags.GetAllocatedSize());
+}
+
+FString USpiderFootholdMap::GetMapPackageName(const FString& WorldPackageName)
+{
+	return WorldPackageName + TEXT("_Footholds");
+}
+
+uint64 USpiderFootholdMap::GetCellKey(const FVector& LocationWorld) const
+{
+	return SpiderFoothold::PackCellKey(
+		FMath::FloorToInt64(LocationWorld.X / CellSize),
+		FMath::FloorToInt64(LocationWorld.Y / CellSize),
+		FMath::FloorToInt64(LocationWorld.Z / CellSize)
+	);
+}
+
+int32 USpiderFootholdMap::FindCell(const uint64& Key) const
+{
+	return Algo::BinarySearch(CellKeys, Key);
+}
+
+bool USpiderFootholdMap::FindFoothold(const FVector& TraceOriginWorld, const FVector& TraceEndWorld,
+                                      FSpiderFoothold& OutFoothold) const
+{
+	if (CellKeys.IsEmpty() || CellSize <= 0) return false;
+
+	FVector TraceDirection = TraceEndWorld - TraceOriginWorld;
+	const double TraceLength = TraceDirection.Size();
+	if (TraceLength < UE_KINDA_SMALL_NUMBER) return false;
+	TraceDirection /= TraceLength;
+
+	// Every cell a sample close enough to the sweep could be in
+	FBox QueryBox(TraceOriginWorld, TraceOriginWorld);
+	QueryBox += TraceEndWorld;
+	QueryBox = QueryBox.ExpandBy(SampleSpacing);
+	if (!QueryBox.Intersect(Bounds)) return false;
+
+	const FIntVector Min(
+		FMath::FloorToInt32(QueryBox.Min.X / CellSize),
+		FMath::FloorToInt32(QueryBox.Min.Y / CellSize),
+		FMath::FloorToInt32(QueryBox.Min.Z / CellSize));
+	const FIntVector Max(
+		FMath::FloorToInt32(QueryBox.Max.X / CellSize),
+		FMath::FloorToInt32(QueryBox.Max.Y / CellSize),
+		FMath::FloorToInt32(QueryBox.Max.Z / CellSize));
+	const FIntVector Size = Max - Min + FIntVector(1);
+	if (Size.X * Size.Y * Size.Z > SpiderFoothold::MaxQueryCells) return false;
+
+	// The walkable sample closest to the sweep holds the surface the sweep would hit, the closest blocking
+	// sample along the sweep tells how far it gets before static geometry stops it
+	int32 ClosestSample = INDEX_NONE;
+	double ClosestDistanceSquared = FMath::Square(SampleSpacing);
+	double BlockingDistance = TNumericLimits<double>::Max();
+	for (int32 Z = Min.Z; Z <= Max.Z; Z++)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+		{
+			for (int32 X = Min.X; X <= Max.X; X++)
+			{
+				const int32 Cell = FindCell(SpiderFoothold::PackCellKey(X, Y, Z));
+				if (Cell == INDEX_NONE) continue;
+
+				for (int32 i = CellStarts[Cell]; i < CellStarts[Cell + 1]; i++)
+				{
+					const double DistanceSquared = FMath::PointDistToSegmentSquared(
+						FVector(Positions[i]), TraceOriginWorld, TraceEndWorld);
+					if (Flags[i] & Foothold_Blocking)
+					{
+						if (DistanceSquared <= FMath::Square(SampleSpacing))
+							BlockingDistance = FMath::Min(BlockingDistance, FVector::DotProduct(
+								FVector(Positions[i]) - TraceOriginWorld, TraceDirection));
+						continue;
+					}
+					if (DistanceSquared >= ClosestDistanceSquared) continue;
+					ClosestDistanceSquared = DistanceSquared;
+					ClosestSample = i;
+				}
+			}
+		}
+	}
+	if (ClosestSample == INDEX_NONE) return false;
+
+	// Solids right under the ground are part of it, only those clearly before it block the sweep
+	const double BlockingTolerance = SampleSpacing * 0.5;
+
+	// Intersect the sweep with the plane of the sample, it has to land within the sweep and the sample
+	const FVector SampleLocation(Positions[ClosestSample]);
+	const FVector SampleNormal(Normals[ClosestSample]);
+	const double Facing = FVector::DotProduct(TraceDirection, SampleNormal);
+	const double Distance = Facing < -UE_KINDA_SMALL_NUMBER
+		                        ? FVector::DotProduct(SampleLocation - TraceOriginWorld, SampleNormal) / Facing
+		                        : -1.0;
+	const FVector GroundLocationWorld = TraceOriginWorld + TraceDirection * Distance;
+	if (Distance >= 0 && Distance <= TraceLength &&
+		FVector::DistSquared(GroundLocationWorld, SampleLocation) <= FMath::Square(SampleSpacing))
+	{
+		if (BlockingDistance < Distance - BlockingTolerance) return false;
+		OutFoothold.Location = GroundLocationWorld;
+		OutFoothold.Normal = SampleNormal;
+		OutFoothold.bIsLedge = false;
+		return true;
+	}
+
+	// Past the edge of a ledge the leg grabs the edge itself
+	if (Flags[ClosestSample] & Foothold_Ledge)
+	{
+		if (BlockingDistance < FVector::DotProduct(SampleLocation - TraceOriginWorld, TraceDirection) -
+			BlockingTolerance)
+			return false;
+		OutFoothold.Location = SampleLocation;
+		OutFoothold.Normal = SampleNormal;
+		OutFoothold.bIsLedge = true;
+		return true;
+	}
+	return false;
+}
+
+#if WITH_EDITOR
+void USpiderFootholdMap::Bake(UWorld* World, const FSpiderFootholdBakeSettings& Settings)
+{
+	LLM_SCOPE_BYTAG(SpiderRig);
+
+	CellKeys.Reset();
+	CellStarts.Reset();
+	Positions.Reset();
+	Normals.Reset();
+	Flags.Reset();
+	Bounds = Settings.Bounds;
+	SampleSpacing = FMath::Max(Settings.SampleSpacing, 1.0f);
+	CellSize = FMath::Max(Settings.CellSize, SampleSpacing);
+	if (!World || !Bounds.IsValid) return;
+
+	// Only static collision is baked, anything which can move is still swept at runtime
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SpiderFootholdBake), false);
+	QueryParams.MobilityType = EQueryMobilityType::Static;
+	const float MinNormalZ = FMath::Cos(FMath::DegreesToRadians(Settings.MaxSlopeDegrees));
+
+	// Trace every column from the top down, a line trace leaving a solid doesn't hit its far side, so restarting
+	// a little below a hit finds the next floor underneath. A trace starting inside a solid only reports the
+	// overlap, it is stepped through and its inside kept as blocking samples.
+	const int32 ColumnsX = FMath::FloorToInt32(Bounds.GetSize().X / SampleSpacing) + 1;
+	const int32 ColumnsY = FMath::FloorToInt32(Bounds.GetSize().Y / SampleSpacing) + 1;
+	TArray<FVector3f> BakedPositions;
+	TArray<FVector3f> BakedNormals;
+	TArray<uint8> BakedFlags;
+	TArray<FIntPoint> BakedColumns;
+	TMap<FIntPoint, TArray<int32>> Columns;
+	for (int32 Y = 0; Y < ColumnsY; Y++)
+	{
+		for (int32 X = 0; X < ColumnsX; X++)
+		{
+			FVector Start(Bounds.Min.X + X * SampleSpacing, Bounds.Min.Y + Y * SampleSpacing, Bounds.Max.Z);
+			const FVector End(Start.X, Start.Y, Bounds.Min.Z);
+			int32 LayerCount = 0;
+			int32 BlockingCount = 0;
+			while (LayerCount < Settings.MaxLayers && Start.Z > End.Z)
+			{
+				FHitResult HitResult;
+				if (!World->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, QueryParams)) break;
+
+				if (HitResult.bStartPenetrating)
+				{
+					if (BlockingCount++ < Settings.MaxBlockingSamples)
+					{
+						BakedPositions.Add(FVector3f(Start));
+						BakedNormals.Add(FVector3f::UpVector);
+						BakedFlags.Add(Foothold_Blocking);
+						BakedColumns.Add(FIntPoint(X, Y));
+					}
+					Start.Z -= SampleSpacing;
+					continue;
+				}
+				Start = HitResult.ImpactPoint - FVector(0, 0, SpiderFoothold::SurfaceOffset);
+				LayerCount++;
+
+				const bool bIsWalkable = HitResult.ImpactNormal.Z >= MinNormalZ;
+				if (bIsWalkable)
+					Columns.FindOrAdd(FIntPoint(X, Y)).Add(BakedPositions.Num());
+				BakedPositions.Add(FVector3f(HitResult.ImpactPoint));
+				BakedNormals.Add(FVector3f(HitResult.ImpactNormal));
+				BakedFlags.Add(bIsWalkable ? 0 : Foothold_Blocking);
+				BakedColumns.Add(FIntPoint(X, Y));
+			}
+		}
+	}
+
+	// A walkable sample without walkable ground next to it at about the same height is on a ledge
+	const FIntPoint Neighbours[] = {FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1)};
+	for (int32 i = 0; i < BakedPositions.Num(); i++)
+	{
+		if (BakedFlags[i] & Foothold_Blocking) continue;
+		for (const FIntPoint& Neighbour : Neighbours)
+		{
+			const TArray<int32>* Column = Columns.Find(BakedColumns[i] + Neighbour);
+			const bool bHasNeighbour = Column && Column->ContainsByPredicate([&](const int32& Other)
+			{
+				return FMath::Abs(BakedPositions[Other].Z - BakedPositions[i].Z) <= Settings.LedgeHeight;
+			});
+			if (bHasNeighbour) continue;
+			BakedFlags[i] |= Foothold_Ledge;
+			break;
+		}
+	}
+
+	// Sort the samples by cell, so every cell is a contiguous range
+	TArray<TPair<uint64, int32>> Order;
+	Order.Reserve(BakedPositions.Num());
+	for (int32 i = 0; i < BakedPositions.Num(); i++)
+		Order.Emplace(GetCellKey(FVector(BakedPositions[i])), i);
+	Order.StableSort([](const TPair<uint64, int32>& A, const TPair<uint64, int32>& B) { return A.Key < B.Key; });
+
+	Positions.Reserve(Order.Num());
+	Normals.Reserve(Order.Num());
+	Flags.Reserve(Order.Num());
+	for (const TPair<uint64, int32>& Entry : Order)
+	{
+		if (CellKeys.IsEmpty() || CellKeys.Last() != Entry.Key)
+		{
+			CellKeys.Add(Entry.Key);
+			CellStarts.Add(Positions.Num());
+		}
+		Positions.Add(BakedPositions[Entry.Value]);
+		Normals.Add(BakedNormals[Entry.Value]);
+		Flags.Add(BakedFlags[Entry.Value]);
+	}
+	CellStarts.Add(Positions.Num());
+}
+#endif
@@ -0,0 +1,219 @@
+#include "SpiderFootholdSubsystem.h"
+
+#include "SpiderFootholdMap.h"
+#include "SpiderRigStats.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/PackageName.h"
+
+static TAutoConsoleVariable<int32> CVarSpiderFootholdsEnable(
+	TEXT("spiderrig.Footholds.Enable"),
+	1,
+	TEXT("Resolve leg sweeps over static collision from the baked foothold maps, 0 sweeps every leg."),
+	ECVF_Default);
+
+namespace SpiderFootholds
+{
+	// Movable collision is looked up by the grid cells the sweep overlaps, a cell covers a few spiders
+	constexpr double MovableCellSize = 1000.0;
+
+	FIntPoint GetCell(const FVector& LocationWorld)
+	{
+		return FIntPoint(FMath::FloorToInt32(LocationWorld.X / MovableCellSize),
+		                 FMath::FloorToInt32(LocationWorld.Y / MovableCellSize));
+	}
+}
+
+void USpiderFootholdSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FWorldDelegates::LevelAddedToWorld.AddUObject(this, &USpiderFootholdSubsystem::OnLevelAdded);
+	FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &USpiderFootholdSubsystem::OnLevelRemoved);
+}
+
+void USpiderFootholdSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.RemoveAll(this);
+	FWorldDelegates::LevelRemovedFromWorld.RemoveAll(this);
+	if (ActorSpawnedHandle.IsValid())
+		GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+
+	Maps.Empty();
+	MapLevels.Empty();
+	ScannedLevels.Empty();
+	MovableComponents.Empty();
+	MovableBounds.Empty();
+	MovableGrid.Empty();
+
+	Super::Deinitialize();
+}
+
+void USpiderFootholdSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	ActorSpawnedHandle = InWorld.AddOnActorSpawnedHandler(
+		FOnActorSpawned::FDelegate::CreateUObject(this, &USpiderFootholdSubsystem::OnActorSpawned));
+
+	// Streamed levels are picked up as they are added, the persistent one is already there
+	for (ULevel* Level : InWorld.GetLevels())
+		OnLevelAdded(Level, &InWorld);
+}
+
+void USpiderFootholdSubsystem::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	if (!Level || World != GetWorld() || ScannedLevels.Contains(Level)) return;
+	ScannedLevels.Add(Level);
+
+	for (const AActor* Actor : Level->Actors)
+		AddMovableComponents(Actor);
+
+	// Maps are baked from the editor package, PIE levels are renamed copies of it
+	const FString WorldPackageName = UWorld::RemovePIEPrefix(Level->GetOutermost()->GetName());
+	const FString MapPackageName = USpiderFootholdMap::GetMapPackageName(WorldPackageName);
+	const FString MapObjectPath = MapPackageName + TEXT(".") + FPackageName::GetShortName(MapPackageName);
+	if (!FPackageName::DoesPackageExist(MapPackageName)) return;
+
+	USpiderFootholdMap* Map = LoadObject<USpiderFootholdMap>(nullptr, *MapObjectPath, nullptr, LOAD_NoWarn | LOAD_Quiet);
+	if (!Map) return;
+
+	Maps.Add(Map);
+	MapLevels.Add(Level);
+	UE_LOG(LogTemp, Display, TEXT("USpiderFootholdSubsystem::OnLevelAdded -> %s, %d footholds"), *MapObjectPath,
+	       Map->GetSampleCount());
+}
+
+void USpiderFootholdSubsystem::OnLevelRemoved(ULevel* Level, UWorld* World)
+{
+	if (World != GetWorld()) return;
+
+	// Its components go stale and drop out on the next tick
+	ScannedLevels.Remove(Level);
+	for (int32 i = Maps.Num() - 1; i >= 0; i--)
+	{
+		if (MapLevels[i] != Level) continue;
+		Maps.RemoveAtSwap(i);
+		MapLevels.RemoveAtSwap(i);
+	}
+}
+
+void USpiderFootholdSubsystem::OnActorSpawned(AActor* Actor)
+{
+	AddMovableComponents(Actor);
+}
+
+void USpiderFootholdSubsystem::AddMovableComponents(const AActor* Actor)
+{
+	// Pawns are left out, the spiders walk on the level and not on each other
+	if (!Actor || Actor->IsA<APawn>()) return;
+
+	// Stationary collision doesn't move either, the bake picks it up along with the static one
+	TInlineComponentArray<UPrimitiveComponent*> Components(Actor);
+	for (UPrimitiveComponent* Component : Components)
+	{
+		if (Component->Mobility != EComponentMobility::Movable || !Component->IsQueryCollisionEnabled()) continue;
+		if (Component->GetCollisionResponseToChannel(ECC_Visibility) != ECR_Block) continue;
+		MovableComponents.Add(Component);
+	}
+}
+
+void USpiderFootholdSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	if (Maps.IsEmpty()) return;
+
+	// Rebuilt every tick, movable collision is expected to be a handful of doors and platforms
+	MovableBounds.Reset();
+	for (TPair<FIntPoint, TArray<int32, TInlineAllocator<4>>>& Cell : MovableGrid)
+		Cell.Value.Reset();
+
+	for (auto Iterator = MovableComponents.CreateIterator(); Iterator; ++Iterator)
+	{
+		const UPrimitiveComponent* Component = Iterator->Get();
+		if (!Component)
+		{
+			Iterator.RemoveCurrent();
+			continue;
+		}
+		if (!Component->IsQueryCollisionEnabled()) continue;
+
+		const FBox Bounds = Component->Bounds.GetBox();
+		const int32 BoundsIndex = MovableBounds.Add(Bounds);
+		const FIntPoint MinCell = SpiderFootholds::GetCell(Bounds.Min);
+		const FIntPoint MaxCell = SpiderFootholds::GetCell(Bounds.Max);
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+				MovableGrid.FindOrAdd(FIntPoint(X, Y)).Add(BoundsIndex);
+		}
+	}
+}
+
+TStatId USpiderFootholdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USpiderFootholdSubsystem, STATGROUP_Tickables);
+}
+
+bool USpiderFootholdSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USpiderFootholdSubsystem::RegisterMap(USpiderFootholdMap* Map)
+{
+	if (!Map || Maps.Contains(Map)) return;
+	Maps.Add(Map);
+	MapLevels.Add(nullptr);
+}
+
+void USpiderFootholdSubsystem::UnregisterMap(USpiderFootholdMap* Map)
+{
+	const int32 Index = Maps.Find(Map);
+	if (Index == INDEX_NONE) return;
+	Maps.RemoveAtSwap(Index);
+	MapLevels.RemoveAtSwap(Index);
+}
+
+bool USpiderFootholdSubsystem::FindFoothold(const FVector& TraceOriginWorld, const FVector& TraceEndWorld,
+                                            const float& TraceRadius, FSpiderFoothold& OutFoothold) const
+{
+	if (Maps.IsEmpty() || !CVarSpiderFootholdsEnable.GetValueOnGameThread()) return false;
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(FindFoothold);
+
+	FBox TraceBox(TraceOriginWorld, TraceOriginWorld);
+	TraceBox += TraceEndWorld;
+	TraceBox = TraceBox.ExpandBy(TraceRadius);
+
+	// Anything movable close by could be in the way, only the physics scene knows where it is
+	const FIntPoint MinCell = SpiderFootholds::GetCell(TraceBox.Min);
+	const FIntPoint MaxCell = SpiderFootholds::GetCell(TraceBox.Max);
+	for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+	{
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+		{
+			const TArray<int32, TInlineAllocator<4>>* Cell = MovableGrid.Find(FIntPoint(X, Y));
+			if (!Cell) continue;
+			for (const int32& BoundsIndex : *Cell)
+			{
+				if (!MovableBounds[BoundsIndex].Intersect(TraceBox)) continue;
+				SPIDERRIG_INC_COUNTER_BY(FootholdMisses, 1);
+				return false;
+			}
+		}
+	}
+
+	for (const USpiderFootholdMap* Map : Maps)
+	{
+		if (!Map->GetBounds().Intersect(TraceBox)) continue;
+		if (!Map->FindFoothold(TraceOriginWorld, TraceEndWorld, OutFoothold)) continue;
+		SPIDERRIG_INC_COUNTER_BY(FootholdHits, 1);
+		return true;
+	}
+
+	SPIDERRIG_INC_COUNTER_BY(FootholdMisses, 1);
+	return false;
+}
@@ -0,0 +1,65 @@
+#include "SpiderGaitNetState.h"
+
+namespace SpiderGaitNet
+{
+	constexpr float LandingImpactStep = 2.0f;
+}
+
+FSpiderGaitNetState FSpiderGaitNetState::Quantize(const float& MotorValue, const float& LaggedHorizontalSpeed,
+                                                  const float& JumpImpact, const uint8& InLandingCount,
+                                                  const bool& bInIsFalling)
+{
+	FSpiderGaitNetState State;
+	// A phase rounded up to a whole cycle wraps back to zero
+	State.MotorPhase = static_cast<uint16>(FMath::RoundToInt32(FMath::Frac(MotorValue) * 65536.0f) & 0xFFFF);
+	State.HorizontalSpeed = static_cast<uint8>(FMath::Clamp(FMath::RoundToInt32(LaggedHorizontalSpeed * 255.0f), 0, 255));
+	State.LandingImpact = static_cast<uint8>(FMath::Clamp(
+		FMath::RoundToInt32(JumpImpact / SpiderGaitNet::LandingImpactStep), 0, 255));
+	State.LandingCount = InLandingCount & LandingCountMask;
+	State.bIsFalling = bInIsFalling;
+	return State;
+}
+
+float FSpiderGaitNetState::GetMotorPhase() const
+{
+	return MotorPhase / 65536.0f;
+}
+
+float FSpiderGaitNetState::GetHorizontalSpeed() const
+{
+	return HorizontalSpeed / 255.0f;
+}
+
+float FSpiderGaitNetState::GetLandingImpact() const
+{
+	return LandingImpact * SpiderGaitNet::LandingImpactStep;
+}
+
+bool FSpiderGaitNetState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// One byte of flags and the landing count, then the gait itself
+	uint8 Header = (bIsFalling ? 1 : 0) | (bHasContactHints ? 2 : 0) | (LandingCount & LandingCountMask) << 2;
+	Ar.SerializeBits(&Header, 5);
+	bIsFalling = (Header & 1) != 0;
+	bHasContactHints = (Header & 2) != 0;
+	LandingCount = Header >> 2 & LandingCountMask;
+
+	Ar << MotorPhase;
+	Ar << HorizontalSpeed;
+	Ar << LandingImpact;
+	if (bHasContactHints)
+		Ar << LegContacts;
+	else if (Ar.IsLoading())
+		LegContacts = 0;
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+bool FSpiderGaitNetState::operator==(const FSpiderGaitNetState& Other) const
+{
+	return MotorPhase == Other.MotorPhase && HorizontalSpeed == Other.HorizontalSpeed &&
+		LandingImpact == Other.LandingImpact && LandingCount == Other.LandingCount &&
+		bIsFalling == Other.bIsFalling && bHasContactHints == Other.bHasContactHints &&
+		LegContacts == Other.LegContacts;
+}
@@ -0,0 +1,59 @@
+#include "SpiderGaitTable.h"
+
+#include "Curves/CurveFloat.h"
+#include "Math/VectorRegister.h"
+
+void FSpiderGaitTable::Bake(const UCurveFloat* Curve, const int32& InResolution)
+{
+	BakedCurve = Curve;
+	Resolution = Curve ? FMath::Max(InResolution, 2) : 0;
+	Values.Reset();
+	if (!Curve) return;
+
+	Values.SetNumUninitialized(Resolution + 1);
+
+	for (int32 i = 0; i <= Resolution; i++)
+		Values[i] = Curve->GetFloatValue(i / static_cast<float>(Resolution));
+}
+
+bool FSpiderGaitTable::IsBakedFrom(const UCurveFloat* Curve, const int32& InResolution) const
+{
+	return BakedCurve == Curve && Resolution == FMath::Max(InResolution, 2);
+}
+
+float FSpiderGaitTable::Sample(const float& Phase) const
+{
+	const float Scaled = FMath::Clamp(Phase, 0.0f, 1.0f) * Resolution;
+	const int32 Index = FMath::Min(FMath::FloorToInt32(Scaled), Resolution - 1);
+	return FMath::Lerp(Values[Index], Values[Index + 1], Scaled - Index);
+}
+
+void FSpiderGaitTable::SampleBatch(const float* Phases, float* OutValues, const int32& Count) const
+{
+	const float* Table = Values.GetData();
+	const VectorRegister4Float Scale = VectorSetFloat1(static_cast<float>(Resolution));
+	const VectorRegister4Float MaxIndex = VectorSetFloat1(static_cast<float>(Resolution - 1));
+
+	int32 i = 0;
+	for (; i + 4 <= Count; i += 4)
+	{
+		// Index and blend factor of four phases at once
+		const VectorRegister4Float Scaled = VectorMultiply(VectorLoad(Phases + i), Scale);
+		const VectorRegister4Float Floor = VectorMin(VectorMax(VectorFloor(Scaled), VectorZeroFloat()), MaxIndex);
+		const VectorRegister4Float Alpha = VectorSubtract(Scaled, Floor);
+
+		alignas(16) int32 Indices[4];
+		VectorIntStoreAligned(VectorFloatToInt(Floor), Indices);
+
+		// The table is small enough to live in cache, gather both ends of every segment
+		const VectorRegister4Float From = MakeVectorRegister(
+			Table[Indices[0]], Table[Indices[1]], Table[Indices[2]], Table[Indices[3]]);
+		const VectorRegister4Float To = MakeVectorRegister(
+			Table[Indices[0] + 1], Table[Indices[1] + 1], Table[Indices[2] + 1], Table[Indices[3] + 1]);
+
+		VectorStore(VectorMultiplyAdd(Alpha, VectorSubtract(To, From), From), OutValues + i);
+	}
+
+	for (; i < Count; i++)
+		OutValues[i] = Sample(Phases[i]);
+}
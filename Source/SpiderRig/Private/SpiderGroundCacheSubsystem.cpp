@@ -0,0 +1,202 @@
+#include "SpiderGroundCacheSubsystem.h"
+
+#include "SpiderRigStats.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarSpiderGroundCacheEnable(
+	TEXT("spiderrig.GroundCache.Enable"),
+	1,
+	TEXT("Share the ground found by leg sweeps between spiders, 0 sweeps every leg."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSpiderGroundCacheCellSize(
+	TEXT("spiderrig.GroundCache.CellSize"),
+	25.0f,
+	TEXT("Size of a ground cache cell in world units."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSpiderGroundCacheLifetime(
+	TEXT("spiderrig.GroundCache.Lifetime"),
+	2.0f,
+	TEXT("Seconds a cached ground sweep stays valid."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSpiderGroundCacheMaxAngle(
+	TEXT("spiderrig.GroundCache.MaxAngle"),
+	20.0f,
+	TEXT("Largest angle in degrees between two sweeps sharing a cached ground."),
+	ECVF_Default);
+
+void USpiderGroundCacheSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Streaming changes the collision under the cells, start over
+	FWorldDelegates::LevelAddedToWorld.AddUObject(this, &USpiderGroundCacheSubsystem::OnLevelChanged);
+	FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &USpiderGroundCacheSubsystem::OnLevelChanged);
+}
+
+void USpiderGroundCacheSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.RemoveAll(this);
+	FWorldDelegates::LevelRemovedFromWorld.RemoveAll(this);
+	Cells.Empty();
+
+	Super::Deinitialize();
+}
+
+void USpiderGroundCacheSubsystem::OnLevelChanged(ULevel* Level, UWorld* World)
+{
+	if (World == GetWorld())
+		InvalidateAll();
+}
+
+void USpiderGroundCacheSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Expired cells are skipped on lookup anyway, prune them once in a while to keep the map small
+	const double Time = GetWorld()->GetTimeSeconds();
+	if (Time < NextPruneTime) return;
+
+	const float Lifetime = CVarSpiderGroundCacheLifetime.GetValueOnGameThread();
+	NextPruneTime = Time + FMath::Max(Lifetime, 0.1f);
+	for (auto Iterator = Cells.CreateIterator(); Iterator; ++Iterator)
+	{
+		if (Time - Iterator.Value().Timestamp > Lifetime)
+			Iterator.RemoveCurrent();
+	}
+}
+
+TStatId USpiderGroundCacheSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USpiderGroundCacheSubsystem, STATGROUP_Tickables);
+}
+
+bool USpiderGroundCacheSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+FIntVector USpiderGroundCacheSubsystem::GetCellKey(const FVector& LocationWorld) const
+{
+	const double CellSize = FMath::Max(CVarSpiderGroundCacheCellSize.GetValueOnGameThread(), 1.0f);
+	return FIntVector(
+		FMath::FloorToInt32(LocationWorld.X / CellSize),
+		FMath::FloorToInt32(LocationWorld.Y / CellSize),
+		FMath::FloorToInt32(LocationWorld.Z / CellSize)
+	);
+}
+
+bool USpiderGroundCacheSubsystem::IsCellValid(const FSpiderGroundCell& Cell, const double& Time) const
+{
+	if (Time - Cell.Timestamp > CVarSpiderGroundCacheLifetime.GetValueOnGameThread()) return false;
+	if (!Cell.bHasComponent) return true;
+
+	// Static collision never moves, anything else has to be where it was when it got hit
+	const UPrimitiveComponent* Component = Cell.Component.Get();
+	if (!Component) return false;
+	return Component->Mobility == EComponentMobility::Static ||
+		Component->GetComponentTransform().Equals(Cell.ComponentTransform);
+}
+
+bool USpiderGroundCacheSubsystem::FindGround(const FVector& LegLocationWorld, const FVector& TraceOriginWorld,
+                                             const FVector& TraceEndWorld, FVector& OutGroundLocationWorld,
+                                             bool& bOutHasGround) const
+{
+	if (!CVarSpiderGroundCacheEnable.GetValueOnGameThread()) return false;
+
+	const FSpiderGroundCell* Cell = Cells.Find(GetCellKey(LegLocationWorld));
+	if (!Cell || !IsCellValid(*Cell, GetWorld()->GetTimeSeconds()))
+	{
+		SPIDERRIG_INC_COUNTER_BY(GroundCacheMisses, 1);
+		return false;
+	}
+
+	// Only sweeps going the same way can share their result
+	FVector TraceDirection = TraceEndWorld - TraceOriginWorld;
+	const double TraceLength = TraceDirection.Size();
+	if (TraceLength < UE_KINDA_SMALL_NUMBER) return false;
+	TraceDirection /= TraceLength;
+
+	const float MaxAngle = FMath::DegreesToRadians(CVarSpiderGroundCacheMaxAngle.GetValueOnGameThread());
+	if (FVector::DotProduct(TraceDirection, Cell->TraceDirection) < FMath::Cos(MaxAngle))
+	{
+		SPIDERRIG_INC_COUNTER_BY(GroundCacheMisses, 1);
+		return false;
+	}
+
+	if (!Cell->bHasGround)
+	{
+		SPIDERRIG_INC_COUNTER_BY(GroundCacheHits, 1);
+		bOutHasGround = false;
+		return true;
+	}
+
+	// Intersect this sweep with the plane of the cached hit, it has to land within the sweep and the cell
+	const double Facing = FVector::DotProduct(TraceDirection, Cell->Normal);
+	const double Distance = Facing < -UE_KINDA_SMALL_NUMBER
+		                        ? FVector::DotProduct(Cell->Location - TraceOriginWorld, Cell->Normal) / Facing
+		                        : -1.0;
+	const FVector GroundLocationWorld = TraceOriginWorld + TraceDirection * Distance;
+	const double CellSize = FMath::Max(CVarSpiderGroundCacheCellSize.GetValueOnGameThread(), 1.0f);
+	if (Distance < 0 || Distance > TraceLength ||
+		FVector::DistSquared(GroundLocationWorld, Cell->Location) > FMath::Square(CellSize * 2.0))
+	{
+		SPIDERRIG_INC_COUNTER_BY(GroundCacheMisses, 1);
+		return false;
+	}
+
+	SPIDERRIG_INC_COUNTER_BY(GroundCacheHits, 1);
+	OutGroundLocationWorld = GroundLocationWorld;
+	bOutHasGround = true;
+	return true;
+}
+
+void USpiderGroundCacheSubsystem::StoreGround(const FVector& LegLocationWorld, const FVector& TraceOriginWorld,
+                                              const FVector& TraceEndWorld, const FHitResult* HitResult)
+{
+	if (!CVarSpiderGroundCacheEnable.GetValueOnGameThread()) return;
+	LLM_SCOPE_BYTAG(SpiderRig);
+
+	// Every spider only ignores itself, the body of a pawn would be served as ground to that very pawn
+	const AActor* HitActor = HitResult ? HitResult->GetActor() : nullptr;
+	if (HitActor && HitActor->IsA<APawn>()) return;
+
+	FSpiderGroundCell& Cell = Cells.FindOrAdd(GetCellKey(LegLocationWorld));
+	Cell.TraceDirection = (TraceEndWorld - TraceOriginWorld).GetSafeNormal();
+	Cell.Timestamp = GetWorld()->GetTimeSeconds();
+	Cell.bHasGround = HitResult != nullptr;
+	Cell.bHasComponent = false;
+	Cell.Component = nullptr;
+	if (!HitResult) return;
+
+	Cell.Location = HitResult->ImpactPoint;
+	Cell.Normal = HitResult->ImpactNormal;
+	if (UPrimitiveComponent* Component = HitResult->GetComponent())
+	{
+		Cell.Component = Component;
+		Cell.ComponentTransform = Component->GetComponentTransform();
+		Cell.bHasComponent = true;
+	}
+}
+
+void USpiderGroundCacheSubsystem::Invalidate(const FBox& BoxWorld)
+{
+	const FIntVector Min = GetCellKey(BoxWorld.Min);
+	const FIntVector Max = GetCellKey(BoxWorld.Max);
+	for (auto Iterator = Cells.CreateIterator(); Iterator; ++Iterator)
+	{
+		const FIntVector& Key = Iterator.Key();
+		if (Key.X >= Min.X && Key.Y >= Min.Y && Key.Z >= Min.Z && Key.X <= Max.X && Key.Y <= Max.Y && Key.Z <= Max.Z)
+			Iterator.RemoveCurrent();
+	}
+}
+
+void USpiderGroundCacheSubsystem::InvalidateAll()
+{
+	Cells.Reset();
+}
@@ -0,0 +1,293 @@
+#include "SpiderLegSolver.h"
+
+#include "Math/VectorRegister.h"
+
+namespace SpiderLegSolver
+{
+	typedef VectorRegister4Float FLanes;
+
+	// Smallest rotation worth applying, the sine of SolveCCDIK's angle threshold squared
+	constexpr float MinSinSquared = UE_KINDA_SMALL_NUMBER * UE_KINDA_SMALL_NUMBER;
+
+	FORCEINLINE FLanes Dot(const FLanes& AX, const FLanes& AY, const FLanes& AZ,
+	                       const FLanes& BX, const FLanes& BY, const FLanes& BZ)
+	{
+		return VectorMultiplyAdd(AX, BX, VectorMultiplyAdd(AY, BY, VectorMultiply(AZ, BZ)));
+	}
+
+	FORCEINLINE void Cross(const FLanes& AX, const FLanes& AY, const FLanes& AZ,
+	                       const FLanes& BX, const FLanes& BY, const FLanes& BZ,
+	                       FLanes& OutX, FLanes& OutY, FLanes& OutZ)
+	{
+		OutX = VectorSubtract(VectorMultiply(AY, BZ), VectorMultiply(AZ, BY));
+		OutY = VectorSubtract(VectorMultiply(AZ, BX), VectorMultiply(AX, BZ));
+		OutZ = VectorSubtract(VectorMultiply(AX, BY), VectorMultiply(AY, BX));
+	}
+
+	FORCEINLINE void Normalize(FLanes& X, FLanes& Y, FLanes& Z)
+	{
+		const FLanes SizeSquared = VectorMax(Dot(X, Y, Z, X, Y, Z), VectorSetFloat1(UE_SMALL_NUMBER));
+		const FLanes InvSize = VectorReciprocalSqrt(SizeSquared);
+		X = VectorMultiply(X, InvSize);
+		Y = VectorMultiply(Y, InvSize);
+		Z = VectorMultiply(Z, InvSize);
+	}
+
+	// Rotate a vector by a unit quaternion: v + w * t + q x t, t = 2 * (q x v)
+	FORCEINLINE void Rotate(const FLanes& QX, const FLanes& QY, const FLanes& QZ, const FLanes& QW,
+	                        FLanes& X, FLanes& Y, FLanes& Z)
+	{
+		const FLanes Two = VectorSetFloat1(2.0f);
+		FLanes TX, TY, TZ;
+		Cross(QX, QY, QZ, X, Y, Z, TX, TY, TZ);
+		TX = VectorMultiply(TX, Two);
+		TY = VectorMultiply(TY, Two);
+		TZ = VectorMultiply(TZ, Two);
+
+		FLanes CX, CY, CZ;
+		Cross(QX, QY, QZ, TX, TY, TZ, CX, CY, CZ);
+		X = VectorAdd(VectorMultiplyAdd(QW, TX, X), CX);
+		Y = VectorAdd(VectorMultiplyAdd(QW, TY, Y), CY);
+		Z = VectorAdd(VectorMultiplyAdd(QW, TZ, Z), CZ);
+	}
+
+	// Apply the delta rotation on top of a bone rotation (Q * R) and renormalize it
+	FORCEINLINE void RotateBone(const FLanes& QX, const FLanes& QY, const FLanes& QZ, const FLanes& QW,
+	                            FSpiderLegSolverBone& Bone)
+	{
+		const FLanes RX = VectorLoad(Bone.RotationX);
+		const FLanes RY = VectorLoad(Bone.RotationY);
+		const FLanes RZ = VectorLoad(Bone.RotationZ);
+		const FLanes RW = VectorLoad(Bone.RotationW);
+
+		FLanes X = VectorAdd(VectorMultiplyAdd(QW, RX, VectorMultiply(QX, RW)),
+		                     VectorSubtract(VectorMultiply(QY, RZ), VectorMultiply(QZ, RY)));
+		FLanes Y = VectorAdd(VectorMultiplyAdd(QW, RY, VectorMultiply(QY, RW)),
+		                     VectorSubtract(VectorMultiply(QZ, RX), VectorMultiply(QX, RZ)));
+		FLanes Z = VectorAdd(VectorMultiplyAdd(QW, RZ, VectorMultiply(QZ, RW)),
+		                     VectorSubtract(VectorMultiply(QX, RY), VectorMultiply(QY, RX)));
+		FLanes W = VectorSubtract(VectorMultiply(QW, RW), Dot(QX, QY, QZ, RX, RY, RZ));
+
+		const FLanes InvSize = VectorReciprocalSqrt(VectorMultiplyAdd(W, W, Dot(X, Y, Z, X, Y, Z)));
+		VectorStore(VectorMultiply(X, InvSize), Bone.RotationX);
+		VectorStore(VectorMultiply(Y, InvSize), Bone.RotationY);
+		VectorStore(VectorMultiply(Z, InvSize), Bone.RotationZ);
+		VectorStore(VectorMultiply(W, InvSize), Bone.RotationW);
+	}
+
+	// Rotate a link so the tip points toward the target, returns the lanes which actually rotated
+	FORCEINLINE FLanes UpdateChainLink(FSpiderLegSolverBone* Chain, const int32& LinkIndex, const int32& TipIndex,
+	                                   const FLanes& TargetX, const FLanes& TargetY, const FLanes& TargetZ,
+	                                   const FLanes& ActiveMask)
+	{
+		FSpiderLegSolverBone& Link = Chain[LinkIndex];
+		const FSpiderLegSolverBone& Tip = Chain[TipIndex];
+
+		const FLanes LinkX = VectorLoad(Link.LocationX);
+		const FLanes LinkY = VectorLoad(Link.LocationY);
+		const FLanes LinkZ = VectorLoad(Link.LocationZ);
+
+		FLanes ToEndX = VectorSubtract(VectorLoad(Tip.LocationX), LinkX);
+		FLanes ToEndY = VectorSubtract(VectorLoad(Tip.LocationY), LinkY);
+		FLanes ToEndZ = VectorSubtract(VectorLoad(Tip.LocationZ), LinkZ);
+		Normalize(ToEndX, ToEndY, ToEndZ);
+
+		FLanes ToTargetX = VectorSubtract(TargetX, LinkX);
+		FLanes ToTargetY = VectorSubtract(TargetY, LinkY);
+		FLanes ToTargetZ = VectorSubtract(TargetZ, LinkZ);
+		Normalize(ToTargetX, ToTargetY, ToTargetZ);
+
+		const FLanes Cos = Dot(ToEndX, ToEndY, ToEndZ, ToTargetX, ToTargetY, ToTargetZ);
+		FLanes AxisX, AxisY, AxisZ;
+		Cross(ToEndX, ToEndY, ToEndZ, ToTargetX, ToTargetY, ToTargetZ, AxisX, AxisY, AxisZ);
+		const FLanes AxisSizeSquared = Dot(AxisX, AxisY, AxisZ, AxisX, AxisY, AxisZ);
+
+		// Only rotate lanes which are still solving and have a meaningful angle, both directions are unit
+		// vectors so the axis size is the sine of the angle, which stays precise for tiny angles unlike the cosine
+		const FLanes RotateMask = VectorBitwiseAnd(
+			ActiveMask,
+			VectorCompareGT(AxisSizeSquared, VectorSetFloat1(MinSinSquared))
+		);
+		if (!VectorMaskBits(RotateMask)) return RotateMask;
+
+		// Clamp the angle to the bone limit, then build the half angle quaternion without any trigonometry
+		const FLanes Half = VectorSetFloat1(0.5f);
+		const FLanes One = VectorOneFloat();
+		const FLanes ClampedCos = VectorMin(VectorMax(Cos, VectorLoad(Link.CosRotationLimit)), One);
+		const FLanes SinHalf = VectorSqrt(VectorMax(VectorMultiply(Half, VectorSubtract(One, ClampedCos)),
+		                                            VectorZeroFloat()));
+		const FLanes CosHalf = VectorSqrt(VectorMultiply(Half, VectorAdd(One, ClampedCos)));
+
+		// Masked lanes get the identity rotation
+		const FLanes AxisScale = VectorSelect(
+			RotateMask,
+			VectorMultiply(SinHalf, VectorReciprocalSqrt(VectorMax(AxisSizeSquared, VectorSetFloat1(UE_SMALL_NUMBER)))),
+			VectorZeroFloat()
+		);
+		const FLanes QX = VectorMultiply(AxisX, AxisScale);
+		const FLanes QY = VectorMultiply(AxisY, AxisScale);
+		const FLanes QZ = VectorMultiply(AxisZ, AxisScale);
+		const FLanes QW = VectorSelect(RotateMask, CosHalf, One);
+
+		RotateBone(QX, QY, QZ, QW, Link);
+
+		// Swing the children around the link
+		for (int32 ChildIndex = LinkIndex + 1; ChildIndex <= TipIndex; ChildIndex++)
+		{
+			FSpiderLegSolverBone& Child = Chain[ChildIndex];
+			FLanes X = VectorSubtract(VectorLoad(Child.LocationX), LinkX);
+			FLanes Y = VectorSubtract(VectorLoad(Child.LocationY), LinkY);
+			FLanes Z = VectorSubtract(VectorLoad(Child.LocationZ), LinkZ);
+			Rotate(QX, QY, QZ, QW, X, Y, Z);
+			VectorStore(VectorAdd(X, LinkX), Child.LocationX);
+			VectorStore(VectorAdd(Y, LinkY), Child.LocationY);
+			VectorStore(VectorAdd(Z, LinkZ), Child.LocationZ);
+			RotateBone(QX, QY, QZ, QW, Child);
+		}
+
+		return RotateMask;
+	}
+}
+
+void FSpiderLegSolver::Reset(const int32& InLegCount, const int32& InMaxChainLength)
+{
+	LegCount = InLegCount;
+	MaxChainLength = InMaxChainLength;
+	GroupCount = FMath::DivideAndRoundUp(LegCount, SPIDER_LEG_SOLVER_LANES);
+
+	Bones.SetNumZeroed(GroupCount * MaxChainLength);
+	Targets.SetNumZeroed(GroupCount);
+	UpdatedLanes.SetNumZeroed(GroupCount);
+	Scales.Init(FVector::OneVector, LegCount * MaxChainLength);
+
+	// Unused lanes stay at the origin with their target, so they never become active
+	for (FSpiderLegSolverBone& Bone : Bones)
+	{
+		for (int32 Lane = 0; Lane < SPIDER_LEG_SOLVER_LANES; Lane++)
+		{
+			Bone.RotationW[Lane] = 1.0f;
+			Bone.CosRotationLimit[Lane] = -1.0f;
+		}
+	}
+}
+
+void FSpiderLegSolver::SetBone(const int32& LegIndex, const int32& BoneIndex, const FTransform& GlobalTransform,
+                               const float& RotationLimit)
+{
+	const int32 Lane = LegIndex % SPIDER_LEG_SOLVER_LANES;
+	FSpiderLegSolverBone& Bone = Bones[(LegIndex / SPIDER_LEG_SOLVER_LANES) * MaxChainLength + BoneIndex];
+
+	const FVector Location = GlobalTransform.GetLocation();
+	const FQuat Rotation = GlobalTransform.GetRotation();
+	Bone.LocationX[Lane] = Location.X;
+	Bone.LocationY[Lane] = Location.Y;
+	Bone.LocationZ[Lane] = Location.Z;
+	Bone.RotationX[Lane] = Rotation.X;
+	Bone.RotationY[Lane] = Rotation.Y;
+	Bone.RotationZ[Lane] = Rotation.Z;
+	Bone.RotationW[Lane] = Rotation.W;
+	Bone.CosRotationLimit[Lane] = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(RotationLimit, 0.0f, 180.0f)));
+
+	Scales[LegIndex * MaxChainLength + BoneIndex] = GlobalTransform.GetScale3D();
+}
+
+void FSpiderLegSolver::PadChain(const int32& LegIndex, const int32& ChainLength)
+{
+	if (ChainLength < 1 || ChainLength >= MaxChainLength) return;
+
+	const FTransform Tip = GetBoneTransform(LegIndex, ChainLength - 1);
+	for (int32 BoneIndex = ChainLength; BoneIndex < MaxChainLength; BoneIndex++)
+		SetBone(LegIndex, BoneIndex, Tip, 0.0f);
+}
+
+void FSpiderLegSolver::SetTarget(const int32& LegIndex, const FVector& TargetGlobal)
+{
+	const int32 Lane = LegIndex % SPIDER_LEG_SOLVER_LANES;
+	FSpiderLegSolverTarget& Target = Targets[LegIndex / SPIDER_LEG_SOLVER_LANES];
+	Target.LocationX[Lane] = TargetGlobal.X;
+	Target.LocationY[Lane] = TargetGlobal.Y;
+	Target.LocationZ[Lane] = TargetGlobal.Z;
+}
+
+void FSpiderLegSolver::SkipLeg(const int32& LegIndex)
+{
+	SetTarget(LegIndex, GetBoneTransform(LegIndex, MaxChainLength - 1).GetLocation());
+}
+
+int32 FSpiderLegSolver::Solve(const float& Precision, const int32& MaxIteration)
+{
+	using namespace SpiderLegSolver;
+
+	int32 MaxIterationUsed = 0;
+	if (MaxChainLength < 2) return MaxIterationUsed;
+
+	const int32 TipIndex = MaxChainLength - 1;
+	const FLanes PrecisionSquared = VectorSetFloat1(Precision * Precision);
+
+	// SolveCCDIK counts its iterations from one, it runs one pass less than it is given
+	const int32 PassCount = MaxIteration - 1;
+
+	for (int32 Group = 0; Group < GroupCount; Group++)
+	{
+		FSpiderLegSolverBone* Chain = &Bones[Group * MaxChainLength];
+		const FSpiderLegSolverBone& Tip = Chain[TipIndex];
+		const FSpiderLegSolverTarget& Target = Targets[Group];
+
+		const FLanes TargetX = VectorLoad(Target.LocationX);
+		const FLanes TargetY = VectorLoad(Target.LocationY);
+		const FLanes TargetZ = VectorLoad(Target.LocationZ);
+
+		FLanes UpdatedMask = VectorZeroFloat();
+		int32 Iteration = 0;
+		for (; Iteration < PassCount; Iteration++)
+		{
+			// Legs which already reached their target stop rotating, the group stops when all of them did
+			const FLanes DeltaX = VectorSubtract(VectorLoad(Tip.LocationX), TargetX);
+			const FLanes DeltaY = VectorSubtract(VectorLoad(Tip.LocationY), TargetY);
+			const FLanes DeltaZ = VectorSubtract(VectorLoad(Tip.LocationZ), TargetZ);
+			const FLanes ActiveMask = VectorCompareGT(Dot(DeltaX, DeltaY, DeltaZ, DeltaX, DeltaY, DeltaZ),
+			                                          PrecisionSquared);
+			if (!VectorMaskBits(ActiveMask)) break;
+
+			FLanes PassMask = VectorZeroFloat();
+			for (int32 LinkIndex = TipIndex - 1; LinkIndex > 0; LinkIndex--)
+			{
+				PassMask = VectorBitwiseOr(
+					PassMask,
+					UpdateChainLink(Chain, LinkIndex, TipIndex, TargetX, TargetY, TargetZ, ActiveMask)
+				);
+			}
+			UpdatedMask = VectorBitwiseOr(UpdatedMask, PassMask);
+
+			// Stuck or unreachable legs won't get any closer, like SolveCCDIK stop once a pass rotates nothing
+			if (!VectorMaskBits(PassMask))
+			{
+				Iteration++;
+				break;
+			}
+		}
+
+		UpdatedLanes[Group] = VectorMaskBits(UpdatedMask);
+		MaxIterationUsed = FMath::Max(MaxIterationUsed, Iteration);
+	}
+
+	return MaxIterationUsed;
+}
+
+bool FSpiderLegSolver::IsLegUpdated(const int32& LegIndex) const
+{
+	const int32 Lane = LegIndex % SPIDER_LEG_SOLVER_LANES;
+	return (UpdatedLanes[LegIndex / SPIDER_LEG_SOLVER_LANES] & (1 << Lane)) != 0;
+}
+
+FTransform FSpiderLegSolver::GetBoneTransform(const int32& LegIndex, const int32& BoneIndex) const
+{
+	const int32 Lane = LegIndex % SPIDER_LEG_SOLVER_LANES;
+	const FSpiderLegSolverBone& Bone = Bones[(LegIndex / SPIDER_LEG_SOLVER_LANES) * MaxChainLength + BoneIndex];
+
+	return FTransform(
+		FQuat(Bone.RotationX[Lane], Bone.RotationY[Lane], Bone.RotationZ[Lane], Bone.RotationW[Lane]),
+		FVector(Bone.LocationX[Lane], Bone.LocationY[Lane], Bone.LocationZ[Lane]),
+		Scales[LegIndex * MaxChainLength + BoneIndex]
+	);
+}
@@ -0,0 +1,48 @@
+#include "SpiderLegTable.h"
+
+void FSpiderLegTable::Reset()
+{
+	IKIndices.Reset();
+	BoneOffsets.Reset();
+	BoneCounts.Reset();
+	FollowsSpine.Reset();
+	RestLocationsGlobal.Reset();
+	BoneIndices.Reset();
+	MaxBoneCount = 0;
+}
+
+int32 FSpiderLegTable::AddLeg(const int32& IKIndex, const TArray<int32>& ChainBoneIndices)
+{
+	const int32 LegIndex = IKIndices.Add(IKIndex);
+	BoneOffsets.Add(BoneIndices.Num());
+	BoneCounts.Add(ChainBoneIndices.Num());
+	FollowsSpine.Add(false);
+	RestLocationsGlobal.Add(FVector::ZeroVector);
+	BoneIndices.Append(ChainBoneIndices);
+	MaxBoneCount = FMath::Max(MaxBoneCount, ChainBoneIndices.Num());
+	return LegIndex;
+}
+
+void FSpiderLegTable::Allocate()
+{
+	const int32 LegCount = Num();
+
+	GaitPhases.Init(0.0f, LegCount);
+	StickGroundFactors.Init(0.0f, LegCount);
+	OffsetFactors.Init(0.0f, LegCount);
+
+	GroundLocationsWorld.Init(FVector::ZeroVector, LegCount);
+	LocationsWorld.Init(FVector::ZeroVector, LegCount);
+	TargetsGlobal.Init(FVector::ZeroVector, LegCount);
+	FinalLocationsGlobal.Init(FVector::ZeroVector, LegCount);
+	Traces.Init(FSpiderLegTrace(), LegCount);
+
+	RootTransforms.Init(FTransform::Identity, LegCount);
+	AccumulatedDeltaTime.Init(0.0f, LegCount);
+	ActiveState.Init(true, LegCount);
+	SolveState.Init(false, LegCount);
+	// Forget previously solved chains, the legs might have changed
+	SolvedState.Init(false, LegCount);
+	SolvedTargets.Init(FVector::ZeroVector, LegCount);
+	SolvedChains.Init(FTransform::Identity, BoneIndices.Num());
+}
@@ -0,0 +1,66 @@
+#include "SpiderMeshComponent.h"
+
+#include "SpiderRig.h"
+#include "IAnimationBudgetAllocator.h"
+
+USpiderMeshComponent::USpiderMeshComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	SetAutoRegisterWithBudgetAllocator(true);
+}
+
+void USpiderMeshComponent::BeginPlay()
+{
+	// Bound before registering, the allocator may ask for reduced work right away
+	OnReduceWork().BindUObject(this, &USpiderMeshComponent::OnReduceWorkChanged);
+	Super::BeginPlay();
+}
+
+void USpiderMeshComponent::OnReduceWorkChanged(USkeletalMeshComponentBudgeted* Component, bool bInReduceWork)
+{
+	bIsWorkReduced = bInReduceWork;
+}
+
+bool USpiderMeshComponent::WillEvaluateThisTick() const
+{
+	// Skipped and interpolated ticks don't evaluate the rig, so they don't need its inputs nor its traces
+	return ShouldTickPose() && (!bExternalTickRateControlled || bExternalUpdate);
+}
+
+void USpiderMeshComponent::TickComponent(float DeltaTime, ELevelTick TickType,
+                                         FActorComponentTickFunction* ThisTickFunction)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	// Snapshot the rig inputs before the evaluation might go wide
+	USpiderRig* Rig = SpiderRig.Get();
+	const bool bWillEvaluate = WillEvaluateThisTick();
+	if (Rig && bWillEvaluate)
+		Rig->PreUpdate();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Parallel evaluations hand their side effects over once they completed
+	if (Rig && bWillEvaluate && !IsRunningParallelEvaluation())
+		Rig->PostUpdate();
+
+	// The allocator only timed the tick itself, add what the rigs spent elsewhere since the last evaluated one
+	if (!bWillEvaluate) return;
+	const uint64 RigCycles = PendingRigCycles.exchange(0);
+	if (RigCycles == 0 || GetAnimationBudgetHandle() == INDEX_NONE) return;
+
+	IAnimationBudgetAllocator* Allocator = IAnimationBudgetAllocator::Get(GetWorld());
+	if (!Allocator) return;
+
+	const uint64 TickCycles = FPlatformTime::Cycles64() - StartCycles;
+	Allocator->SetGameThreadLastTickTimeMs(GetAnimationBudgetHandle(),
+	                                       FPlatformTime::ToMilliseconds64(TickCycles + RigCycles));
+}
+
+void USpiderMeshComponent::CompleteParallelAnimationEvaluation(bool bDoPostAnimEvaluation)
+{
+	Super::CompleteParallelAnimationEvaluation(bDoPostAnimEvaluation);
+
+	if (USpiderRig* Rig = SpiderRig.Get())
+		Rig->PostUpdate();
+}
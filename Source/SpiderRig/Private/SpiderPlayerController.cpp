@@ -4,15 +4,14 @@
 #include "InputMappingContext.h"
 #include "SpiderCamera.h"
 #include "SpiderCharacter.h"
+#include "Engine/AssetManager.h"
+#include "Engine/LocalPlayer.h"
 
 void ASpiderPlayerController::OnPossess(APawn* NewPawn)
 {
 	Super::OnPossess(NewPawn);
 	PossessedCharacter = Cast<ASpiderCharacter>(NewPawn);
 	NotifyCameraAboutPossession(NewPawn);
-	SetupInputSystem();
-	UnBindInputs();
-	BindInputs();
 	UE_LOG(LogTemp, Error, TEXT("ASpiderPlayerController::OnPossess"));
 }
 
@@ -20,11 +19,74 @@ void ASpiderPlayerController::OnUnPossess()
 {
 	Super::OnUnPossess();
 	NotifyCameraAboutPossession(nullptr);
-	UnBindInputs();
 	PossessedCharacter = nullptr;
 	UE_LOG(LogTemp, Error, TEXT("ASpiderPlayerController::OnUnPossess"));
 }
 
+void ASpiderPlayerController::BeginPlay()
+{
+	Super::BeginPlay();
+	if (InputMappingContext.IsNull() || !IsLocalController()) return;
+
+	// Called right away when the context is already loaded
+	MappingContextHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		InputMappingContext.ToSoftObjectPath(),
+		FStreamableDelegate::CreateUObject(this, &ASpiderPlayerController::OnMappingContextLoaded));
+}
+
+void ASpiderPlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (MappingContextHandle.IsValid())
+	{
+		MappingContextHandle->CancelHandle();
+		MappingContextHandle.Reset();
+	}
+	UnBindInputs();
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASpiderPlayerController::OnMappingContextLoaded()
+{
+	// The actions are referenced by the context, they were loaded along with it
+	LoadedMappingContext = InputMappingContext.Get();
+	if (!LoadedMappingContext)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ASpiderPlayerController::OnMappingContextLoaded -> Unable to load %s"),
+		       *InputMappingContext.ToString());
+		return;
+	}
+	SetupInputSystem();
+	BindInputs();
+}
+
+void ASpiderPlayerController::SetupInputComponent()
+{
+	Super::SetupInputComponent();
+
+	// A new input component needs the bindings again, if the context isn't loaded yet they come along with it
+	SetupInputSystem();
+	BindInputs();
+}
+
+void ASpiderPlayerController::PostProcessInput(const float DeltaTime, const bool bGamePaused)
+{
+	Super::PostProcessInput(DeltaTime, bGamePaused);
+
+	// Whatever triggered this frame is applied in a single pass, the values read by the camera last a frame
+	MoveInputValue = bHasPendingMoveInput ? PendingMoveInput : FVector2D::ZeroVector;
+	LookInputValue = PendingLookInput;
+	PendingMoveInput = FVector2D::ZeroVector;
+	PendingLookInput = FVector2D::ZeroVector;
+	const bool bHasMoveInput = bHasPendingMoveInput;
+	bHasPendingMoveInput = false;
+
+	if (!PossessedCharacter) return;
+	if (!LookInputValue.IsZero())
+		PossessedCharacter->ApplyCameraMovement(LookInputValue);
+	if (bHasMoveInput)
+		PossessedCharacter->ApplyCharacterMovement(MoveInputValue);
+}
+
 void ASpiderPlayerController::NotifyCameraAboutPossession(APawn* NewPawn) const
 {
 	if (!PlayerCameraManager->IsA<ASpiderCamera>()) return;
@@ -34,24 +96,44 @@ void ASpiderPlayerController::NotifyCameraAboutPossession(APawn* NewPawn) const
 
 void ASpiderPlayerController::BindInputs()
 {
-	if (InputMappingContext.IsNull()) return;
+	if (!LoadedMappingContext) return;
 	if (!InputComponent.IsA<UEnhancedInputComponent>()) return;
+	if (BoundInputComponent == InputComponent) return;
 
 	UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(InputComponent);
+	BindingHandles.Reset();
+	BoundInputComponent = EnhancedInputComponent;
 
-	const auto& Mappings = InputMappingContext.LoadSynchronous()->GetMappings();
+	const auto& Mappings = LoadedMappingContext->GetMappings();
 
 	TSet<const UInputAction*> UniqueActions;
 	for (const FEnhancedActionKeyMapping& Keymapping : Mappings)
 		UniqueActions.Add(Keymapping.Action);
 
+	// Actions are still matched by name, but dispatched to the handlers without going through reflection
+	using FInputHandler = void (ASpiderPlayerController::*)(const FInputActionValue&);
+	static const TMap<FName, FInputHandler> Handlers = {
+		{TEXT("MoveInputAction"), &ASpiderPlayerController::MoveInputAction},
+		{TEXT("LookInputAction"), &ASpiderPlayerController::LookInputAction},
+		{TEXT("JumpInputAction"), &ASpiderPlayerController::JumpInputAction},
+	};
+
 	for (const UInputAction* UniqueAction : UniqueActions)
 	{
+		if (!UniqueAction) continue;
+		const FInputHandler* Handler = Handlers.Find(UniqueAction->GetFName());
+		if (!Handler)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ASpiderPlayerController::BindInputs -> No handler for %s"),
+			       *UniqueAction->GetName());
+			continue;
+		}
+
 		const auto& Handle = EnhancedInputComponent->BindAction(
 			UniqueAction,
 			ETriggerEvent::Triggered,
-			Cast<UObject>(this),
-			UniqueAction->GetFName()
+			this,
+			*Handler
 		);
 		BindingHandles.Add(Handle.GetHandle());
 	}
@@ -59,16 +141,18 @@ void ASpiderPlayerController::BindInputs()
 
 void ASpiderPlayerController::UnBindInputs()
 {
-	UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(InputComponent);
-	for (const uint32& BindingHandle : BindingHandles)
-		EnhancedInputComponent->RemoveBindingByHandle(BindingHandle);
+	if (UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(BoundInputComponent.Get()))
+	{
+		for (const uint32& BindingHandle : BindingHandles)
+			EnhancedInputComponent->RemoveBindingByHandle(BindingHandle);
+	}
 	BindingHandles.Empty();
+	BoundInputComponent = nullptr;
 }
 
 void ASpiderPlayerController::SetupInputSystem() const
 {
-	if (!PossessedCharacter) return;
-	if (InputMappingContext.IsNull()) return;
+	if (!LoadedMappingContext) return;
 
 	const ULocalPlayer* LocalPlayer = GetLocalPlayer();
 	if (!LocalPlayer) return;
@@ -76,24 +160,24 @@ void ASpiderPlayerController::SetupInputSystem() const
 	UEnhancedInputLocalPlayerSubsystem* InputSystem = LocalPlayer->GetSubsystem<UEnhancedInputLocalPlayerSubsystem>();
 	if (!InputSystem) return;
 
-	InputSystem->AddMappingContext(InputMappingContext.LoadSynchronous(), 0);
+	if (!InputSystem->HasMappingContext(LoadedMappingContext))
+		InputSystem->AddMappingContext(LoadedMappingContext, 0);
 }
 
 void ASpiderPlayerController::MoveInputAction(const FInputActionValue& Value)
 {
-	if (!PossessedCharacter) return;
-	MoveInputValue = Value.Get<FVector2D>();
-	PossessedCharacter->ApplyCharacterMovement(MoveInputValue);
+	// The move value is where the stick is, the latest one wins
+	PendingMoveInput = Value.Get<FVector2D>();
+	bHasPendingMoveInput = true;
 }
 
 void ASpiderPlayerController::LookInputAction(const FInputActionValue& Value)
 {
-	if (!PossessedCharacter) return;
-	LookInputValue = Value.Get<FVector2D>();
-	PossessedCharacter->ApplyCameraMovement(LookInputValue);
+	// Look values are deltas, they add up
+	PendingLookInput += Value.Get<FVector2D>();
 }
 
-void ASpiderPlayerController::JumpInputAction(const FInputActionValue& Value) const
+void ASpiderPlayerController::JumpInputAction(const FInputActionValue& Value)
 {
 	if (!PossessedCharacter) return;
 	PossessedCharacter->ApplyJump();
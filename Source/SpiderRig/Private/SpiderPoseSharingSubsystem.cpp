@@ -0,0 +1,167 @@
+#include "SpiderPoseSharingSubsystem.h"
+
+#include "SpiderRig.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarSpiderPoseSharingEnable(
+	TEXT("spiderrig.PoseSharing.Enable"),
+	1,
+	TEXT("Let far spiders copy the pose of a leader rig of the same gait, 0 evaluates every rig on its own."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarSpiderPoseSharingMinLOD(
+	TEXT("spiderrig.PoseSharing.MinLOD"),
+	2,
+	TEXT("Spiders from this LOD on copy the pose of their leader."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarSpiderPoseSharingSlots(
+	TEXT("spiderrig.PoseSharing.Slots"),
+	16,
+	TEXT("Poses recorded over a walking or running gait cycle, read when a bucket is created."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSpiderPoseSharingWalkSpeed(
+	TEXT("spiderrig.PoseSharing.WalkSpeed"),
+	0.05f,
+	TEXT("Fraction of the max walk speed from which a spider walks instead of stalling."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSpiderPoseSharingRunSpeed(
+	TEXT("spiderrig.PoseSharing.RunSpeed"),
+	0.6f,
+	TEXT("Fraction of the max walk speed from which a spider runs."),
+	ECVF_Default);
+
+namespace SpiderPoseSharing
+{
+	// Leaders which stopped evaluating (culled, destroyed, another gait) hand the bucket over after this long
+	constexpr double LeaderTimeout = 0.5;
+}
+
+void USpiderPoseSharingSubsystem::Deinitialize()
+{
+	Buckets.Empty();
+	Super::Deinitialize();
+}
+
+bool USpiderPoseSharingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+ESpiderGaitBucket USpiderPoseSharingSubsystem::ClassifyGait(const float& HorizontalSpeed, const bool& bIsFalling)
+{
+	if (bIsFalling) return ESpiderGaitBucket::Falling;
+	if (HorizontalSpeed < CVarSpiderPoseSharingWalkSpeed.GetValueOnGameThread()) return ESpiderGaitBucket::Stall;
+	if (HorizontalSpeed < CVarSpiderPoseSharingRunSpeed.GetValueOnGameThread()) return ESpiderGaitBucket::Walk;
+	return ESpiderGaitBucket::Run;
+}
+
+int32 USpiderPoseSharingSubsystem::FindOrAddBucket(const UClass* RigClass, const ESpiderGaitBucket& Gait)
+{
+	const int32 Existing = Buckets.IndexOfByPredicate([RigClass, Gait](const FSpiderPoseBucket& Bucket)
+	{
+		return Bucket.RigClass == RigClass && Bucket.Gait == Gait;
+	});
+	if (Existing != INDEX_NONE) return Existing;
+
+	// Standing and falling poses don't cycle, a single pose covers them
+	FSpiderPoseBucket& Bucket = Buckets.AddDefaulted_GetRef();
+	Bucket.RigClass = RigClass;
+	Bucket.Gait = Gait;
+	Bucket.SlotCount = Gait == ESpiderGaitBucket::Walk || Gait == ESpiderGaitBucket::Run
+		                   ? FMath::Clamp(CVarSpiderPoseSharingSlots.GetValueOnGameThread(), 1, 256)
+		                   : 1;
+	return Buckets.Num() - 1;
+}
+
+ESpiderPoseRole USpiderPoseSharingSubsystem::RequestRole(USpiderRig* Rig, const ESpiderGaitBucket& Gait,
+                                                         const int32& LOD, const bool& bCanLead,
+                                                         int32& OutBucketIndex)
+{
+	OutBucketIndex = INDEX_NONE;
+	if (!Rig || CVarSpiderPoseSharingEnable.GetValueOnGameThread() == 0) return ESpiderPoseRole::None;
+
+	OutBucketIndex = FindOrAddBucket(Rig->GetClass(), Gait);
+	FSpiderPoseBucket& Bucket = Buckets[OutBucketIndex];
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// A far leader is only kept until a closer spider of the bucket can take over
+	const bool bIsFar = LOD >= CVarSpiderPoseSharingMinLOD.GetValueOnGameThread();
+	if (Bucket.Leader == Rig)
+	{
+		Bucket.LeaderSeenTime = Now;
+		Bucket.bIsLeaderFar = bIsFar;
+		return ESpiderPoseRole::Leader;
+	}
+
+	// A leader leads a single bucket, moving away or to another gait gives it up
+	for (FSpiderPoseBucket& Other : Buckets)
+	{
+		if (Other.Leader == Rig)
+			Other.Leader = nullptr;
+	}
+
+	// Without any close spider the first far one leads, the rig evaluates its leader at full quality
+	const bool bHasLeader = Bucket.Leader.IsValid() && Now - Bucket.LeaderSeenTime <= SpiderPoseSharing::LeaderTimeout;
+	if (bCanLead && (!bHasLeader || (Bucket.bIsLeaderFar && !bIsFar)))
+	{
+		Bucket.Leader = Rig;
+		Bucket.LeaderSeenTime = Now;
+		Bucket.bIsLeaderFar = bIsFar;
+		return ESpiderPoseRole::Leader;
+	}
+
+	// Only far spiders follow, and only once the whole cycle was recorded
+	if (bIsFar && Bucket.IsReady())
+		return ESpiderPoseRole::Follower;
+	return ESpiderPoseRole::None;
+}
+
+bool USpiderPoseSharingSubsystem::SamplePose(const int32& BucketIndex, const float& Phase,
+                                             TArray<FTransform>& OutPose) const
+{
+	if (!Buckets.IsValidIndex(BucketIndex)) return false;
+	const FSpiderPoseBucket& Bucket = Buckets[BucketIndex];
+	if (!Bucket.IsReady()) return false;
+
+	// Blend the two slots around the phase, the last slot wraps back to the first
+	const float ScaledPhase = FMath::Frac(Phase) * Bucket.SlotCount;
+	const int32 SlotA = FMath::Min(FMath::FloorToInt32(ScaledPhase), Bucket.SlotCount - 1);
+	const int32 SlotB = (SlotA + 1) % Bucket.SlotCount;
+	const float Alpha = ScaledPhase - SlotA;
+
+	const FTransform* PoseA = &Bucket.Slots[SlotA * Bucket.PoseSize];
+	const FTransform* PoseB = &Bucket.Slots[SlotB * Bucket.PoseSize];
+	OutPose.SetNumUninitialized(Bucket.PoseSize, EAllowShrinking::No);
+	for (int32 i = 0; i < Bucket.PoseSize; i++)
+		OutPose[i].Blend(PoseA[i], PoseB[i], Alpha);
+	return true;
+}
+
+void USpiderPoseSharingSubsystem::PublishPose(const USpiderRig* Rig, const int32& BucketIndex, const float& Phase,
+                                              const TArray<FTransform>& Pose)
+{
+	if (!Buckets.IsValidIndex(BucketIndex) || Pose.IsEmpty()) return;
+	FSpiderPoseBucket& Bucket = Buckets[BucketIndex];
+	if (Bucket.Leader != Rig) return;
+
+	// A rig of the same class driving a different set of bones starts the recording over
+	if (Bucket.PoseSize != Pose.Num())
+	{
+		Bucket.PoseSize = Pose.Num();
+		Bucket.Slots.SetNumUninitialized(Bucket.SlotCount * Bucket.PoseSize);
+		Bucket.FilledSlots.Init(false, Bucket.SlotCount);
+		Bucket.FilledCount = 0;
+	}
+
+	const int32 Slot = FMath::RoundToInt32(FMath::Frac(Phase) * Bucket.SlotCount) % Bucket.SlotCount;
+	FMemory::Memcpy(&Bucket.Slots[Slot * Bucket.PoseSize], Pose.GetData(), Bucket.PoseSize * sizeof(FTransform));
+	if (!Bucket.FilledSlots[Slot])
+	{
+		Bucket.FilledSlots[Slot] = true;
+		Bucket.FilledCount++;
+	}
+}
@@ -3,11 +3,104 @@
 
 #include "SpiderRig.h"
 
+#include "SpiderCharacter.h"
+#include "SpiderCrowdSubsystem.h"
+#include "SpiderFootholdMap.h"
+#include "SpiderFootholdSubsystem.h"
+#include "SpiderGroundCacheSubsystem.h"
+#include "SpiderMeshComponent.h"
+#include "SpiderPoseSharingSubsystem.h"
+#include "SpiderRigCounters.h"
+#include "SpiderRigStats.h"
 #include "SpiderEffectsComponent.h"
 #include "Math/Transform.h"
 #include "Math/Vector.h"
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Camera/PlayerCameraManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Curves/CurveFloat.h"
+#include "Misc/ScopeExit.h"
+
+
+static TAutoConsoleVariable<int32> CVarSpiderRigLODMode(
+	TEXT("spiderrig.LOD.Mode"),
+	1,
+	TEXT("How spider rigs pick their LOD. 0: always full quality, 1: distance to the closest view, 2: screen size."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarSpiderRigLODForce(
+	TEXT("spiderrig.LOD.Force"),
+	-1,
+	TEXT("Force every spider rig into this LOD, -1 to disable."),
+	ECVF_Cheat);
+
+static TAutoConsoleVariable<float> CVarSpiderRigLODHysteresis(
+	TEXT("spiderrig.LOD.Hysteresis"),
+	0.1f,
+	TEXT("Fraction of a threshold a spider rig has to cross before it goes back to the previous LOD."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarSpiderRigLODBlendTime(
+	TEXT("spiderrig.LOD.BlendTime"),
+	0.5f,
+	TEXT("Seconds a spider rig takes to blend into its new LOD."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarSpiderRigBudgetReducedLOD(
+	TEXT("spiderrig.Budget.ReducedLOD"),
+	2,
+	TEXT("Lowest quality LOD spider rigs go to while the animation budget allocator asks for reduced work."),
+	ECVF_Scalability);
+
+static FString GSpiderRigLODDistances = TEXT("1500,4000,8000");
+static FString GSpiderRigLODScreenSizes = TEXT("0.25,0.1,0.03");
+static bool GSpiderRigLODThresholdsDirty = true;
+
+static void MarkSpiderRigLODThresholdsDirty(IConsoleVariable*)
+{
+	GSpiderRigLODThresholdsDirty = true;
+}
+
+static FAutoConsoleVariableRef CVarSpiderRigLODDistances(
+	TEXT("spiderrig.LOD.Distances"),
+	GSpiderRigLODDistances,
+	TEXT("Comma separated distances at which spider rigs go to the next LOD."),
+	FConsoleVariableDelegate::CreateStatic(&MarkSpiderRigLODThresholdsDirty),
+	ECVF_Scalability);
+
+static FAutoConsoleVariableRef CVarSpiderRigLODScreenSizes(
+	TEXT("spiderrig.LOD.ScreenSizes"),
+	GSpiderRigLODScreenSizes,
+	TEXT("Comma separated screen sizes under which spider rigs go to the next LOD."),
+	FConsoleVariableDelegate::CreateStatic(&MarkSpiderRigLODThresholdsDirty),
+	ECVF_Scalability);
+
+namespace SpiderRigLOD
+{
+	TArray<float> DistanceThresholds;
+	TArray<float> ScreenSizeThresholds;
+
+	void ParseThresholds(const FString& Source, TArray<float>& OutThresholds)
+	{
+		TArray<FString> Values;
+		Source.ParseIntoArray(Values, TEXT(","));
+		OutThresholds.Reset();
+		for (const FString& Value : Values)
+			OutThresholds.Add(FCString::Atof(*Value.TrimStartAndEnd()));
+	}
+
+	// Only parsed on the game thread, where the rigs pick their LOD
+	void UpdateThresholds()
+	{
+		if (!GSpiderRigLODThresholdsDirty) return;
+		ParseThresholds(GSpiderRigLODDistances, DistanceThresholds);
+		ParseThresholds(GSpiderRigLODScreenSizes, ScreenSizeThresholds);
+		GSpiderRigLODThresholdsDirty = false;
+	}
+}
 
 
 bool USpiderRig::InitializeSpine()
@@ -50,25 +143,12 @@ bool USpiderRig::InitializeLegs()
 		return false;
 	}
 
-	// Initialize legs
-	LegLength = Legs.Num();
-
-	// Resize arrays so the can fit legs
-	if (LegLocationsWorld.Num() != LegLength)
-		LegLocationsWorld.SetNum(LegLength, EAllowShrinking::No);
+	// Initialize legs, any number of legs and bones is packed into the table
+	LegTable.Reset();
+	TArray<int32> ChainBoneIndices;
 
-	if (FinalLegLocationsGlobal.Num() != LegLength)
-		FinalLegLocationsGlobal.SetNum(LegLength, EAllowShrinking::No);
-
-	if (LegState.Num() != LegLength)
-		LegState.SetNum(LegLength, EAllowShrinking::No);
-
-
-	for (int32 i = 0; i < LegLength; i++)
+	for (int32 i = 0; i < Legs.Num(); i++)
 	{
-		int j = 0;
-		LegLocationsWorld[i] = FVector(0, 0, 0);
-		FinalLegLocationsGlobal[i] = FVector(0, 0, 0);
 		const FSpiderLegDef& Leg = Legs[i];
 
 		if (!Leg.IK.IsValid() || (BoneIndex = RigHierarchy->GetIndex(Leg.IK)) == INDEX_NONE)
@@ -76,20 +156,16 @@ bool USpiderRig::InitializeLegs()
 			UE_LOG(LogTemp, Error, TEXT("USpiderRig::InitializeLegs -> Invalid IK for Leg[%d]"), i);
 			return false;
 		}
+		const int32 IKIndex = BoneIndex;
 
-		// First value of LegIndices is the IK index
-		LegIndices[i][j++] = BoneIndex;
 		if (!Leg.Bones.Num())
 		{
 			UE_LOG(LogTemp, Error, TEXT("USpiderRig::InitializeLegs -> Invalid length for Leg[%d]"), i);
 			return false;
 		}
 
-		// second value of LegIndices is the chain length
-		const int32 BonesLength = Leg.Bones.Num();
-		LegIndices[i][j++] = BonesLength;
-
-		for (int32 k = 0; k < BonesLength; k++)
+		ChainBoneIndices.Reset();
+		for (int32 k = 0; k < Leg.Bones.Num(); k++)
 		{
 			const auto& BoneKey = Leg.Bones[k];
 			if (!BoneKey.IsValid() || (BoneIndex = RigHierarchy->GetIndex(BoneKey)) == INDEX_NONE)
@@ -97,10 +173,30 @@ bool USpiderRig::InitializeLegs()
 				UE_LOG(LogTemp, Error, TEXT("USpiderRig::InitializeLegs -> Invalid bone at Leg[%d][%d]"), i, k);
 				return false;
 			}
-			// the rest are bone indices for faster lookup
-			LegIndices[i][j++] = BoneIndex;
+			ChainBoneIndices.Add(BoneIndex);
 		}
+
+		const int32 LegIndex = LegTable.AddLeg(IKIndex, ChainBoneIndices);
+
+		// Initial transforms never change at runtime, keep the rest location of every leg
+		LegTable.RestLocationsGlobal[LegIndex] = RigHierarchy->GetInitialGlobalTransform(IKIndex).GetLocation();
+
+		// Legs under the spine move along with it, the solver needs to know which ones do
+		LegTable.FollowsSpine[LegIndex] = RigHierarchy->IsParentedTo(Leg.Bones[0], Spine.Bone);
+	}
+
+	LegTable.Allocate();
+	BoneWrites.Reset();
+
+	// Contact hints fit in a byte, the legs past it follow the gait alone on clients
+	if (bReplicateContactHints && LegTable.Num() > FSpiderGaitNetState::MaxContactHints)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("USpiderRig::InitializeLegs -> only the first %d of %d legs replicate contact hints"),
+		       FSpiderGaitNetState::MaxContactHints, LegTable.Num());
 	}
+
+	// Allocate the batched solver for every leg at once
+	LegSolver.Reset(LegTable.Num(), LegTable.GetMaxBoneCount());
 	return true;
 }
 
@@ -110,6 +206,7 @@ bool USpiderRig::InitializeVariables()
 	if (!ParentActor) return false;
 	if (!ParentActor->IsA<ACharacter>()) return false;
 	ParentCharacter = Cast<ACharacter>(ParentActor);
+	SpiderCharacter = Cast<ASpiderCharacter>(ParentActor);
 
 	CharacterMovementComponent = ParentCharacter->GetCharacterMovement();
 	if (!CharacterMovementComponent) return false;
@@ -123,23 +220,66 @@ bool USpiderRig::InitializeVariables()
 	SpiderEffects = ParentActor->GetComponentByClass<USpiderEffectsComponent>();
 	if (!SpiderEffects) return false;
 
+	// Query params are shared by every sweep of this rig, build them once
+	TraceQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(SpiderRigLegTrace), false, ParentActor);
+
 	return true;
 }
 
+void USpiderRig::BakeGaitTables()
+{
+	ToeStickGroundTable.Bake(ToeStickGroundTimeline, GaitTableResolution);
+	ToeOffsetTable.Bake(ToeOffsetTimeline, GaitTableResolution);
+
+#if WITH_EDITOR
+	bGaitTablesDirty = false;
+#endif
+}
+
 void USpiderRig::Initialize(bool bRequestInit)
 {
+	LLM_SCOPE_BYTAG(SpiderRig);
 	if (!InitializeVariables()) return;
 	if (!InitializeSpine()) return;
 	if (!InitializeLegs()) return;
+
+	// Bake the curves once, the gait only ever samples a single cycle of them
+	BakeGaitTables();
+
+#if WITH_EDITOR
+	// Re-bake whenever a curve gets edited while the rig is running, once the edit was applied
+	if (!CurveModifiedHandle.IsValid())
+	{
+		CurveModifiedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddWeakLambda(
+			this, [this](UObject* Object, FPropertyChangedEvent&)
+			{
+				if (Object && (Object == ToeStickGroundTimeline || Object == ToeOffsetTimeline))
+					bGaitTablesDirty = true;
+			});
+	}
+#endif
+
+	// Start at full quality
+	CurrentLOD = 0;
+	LODBlendAlpha = 1.0f;
+	BlendedLOD = GetLODDef(CurrentLOD);
+	BlendFromLOD = BlendedLOD;
+	GameThreadLOD = 0;
+	bGameThreadLegsFrozen = false;
+
+	// The driven bones might have changed, start the fixed timestep over
+	bHasFixedStepPose = false;
 	bIsReady = true;
 }
 
 
-bool USpiderRig::Execute(const FName& InEventName)
+void USpiderRig::PreUpdate()
 {
-	Super::Execute(InEventName);
-	// If initialization failed, don't bother running the simulation!
-	if (!bIsReady) return false;
+	check(IsInGameThread());
+	if (!bIsReady) return;
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(PreUpdate);
+	LLM_SCOPE_BYTAG(SpiderRig);
+	SPIDERRIG_CYCLE_COUNTER_SCOPE(PreUpdateCycles);
 
 	// initialize runtime variables
 	if (!bIsInitialized)
@@ -147,33 +287,472 @@ bool USpiderRig::Execute(const FName& InEventName)
 		if (!ParentSceneComponent)
 		{
 			ParentSceneComponent = GetOwningSceneComponent();
-			if (!ParentSceneComponent) return false;
+			if (!ParentSceneComponent) return;
+			SpiderMesh = Cast<USpiderMeshComponent>(ParentSceneComponent);
 		}
 		if (!LivingWorld)
 		{
 			LivingWorld = GetWorld();
-			if (!LivingWorld) return false;
+			if (!LivingWorld) return;
 		}
 		bIsInitialized = true;
 	}
 
+	// Keep the sweep shape in sync with the configured radius
+	if (!TraceCollisionShape.IsSphere() || TraceCollisionShape.GetSphereRadius() != ToeTraceRadius)
+		TraceCollisionShape = FCollisionShape::MakeSphere(ToeTraceRadius);
+
+
+	// Join or leave the crowd, the crowd solves on the worker threads at the end of the frame
+	if (bUseCrowdEvaluation != CrowdSubsystem.IsValid())
+	{
+		if (bUseCrowdEvaluation)
+		{
+			CrowdSubsystem = LivingWorld->GetSubsystem<USpiderCrowdSubsystem>();
+			if (USpiderCrowdSubsystem* Crowd = CrowdSubsystem.Get())
+				Crowd->RegisterRig(this);
+		}
+		else
+		{
+			CrowdSubsystem->UnregisterRig(this);
+			CrowdSubsystem.Reset();
+			bHasPendingCrowdFrame = false;
+		}
+	}
+
+	// Share the ground with the other spiders of the world
+	if (bUseGroundCache != (GroundCache != nullptr))
+		GroundCache = bUseGroundCache ? LivingWorld->GetSubsystem<USpiderGroundCacheSubsystem>() : nullptr;
+	if (bUseFootholdMap != (FootholdSubsystem != nullptr))
+		FootholdSubsystem = bUseFootholdMap ? LivingWorld->GetSubsystem<USpiderFootholdSubsystem>() : nullptr;
+
+
+	// Snapshot everything the evaluation reads from the character and the world
+	Inputs.ComponentTransform = ParentSceneComponent->GetComponentTransform();
+	Inputs.VelocityWorld = CharacterMovementComponent->Velocity;
+	Inputs.MaxWalkSpeed = CharacterMovementComponent->MaxWalkSpeed;
+	Inputs.bIsFalling = CharacterMovementComponent->IsFalling();
+	Inputs.ActorLocationWorld = ParentCharacter->GetActorLocation();
+	Inputs.bIsPawnControlled = ParentCharacter->IsPawnControlled();
+	Inputs.ElapsedTime = LivingWorld->GetTimeSeconds();
+	Inputs.TargetLOD = CalculateLOD();
+	Inputs.LODBlendTime = CVarSpiderRigLODBlendTime.GetValueOnGameThread();
+
+	// Simulated spiders converge to the gait of the server, which publishes it in the post-update
+	Inputs.bIsNetDriven = bReplicateGait && SpiderCharacter &&
+		SpiderCharacter->GetLocalRole() == ROLE_SimulatedProxy;
+	if (Inputs.bIsNetDriven && SpiderCharacter->GetGaitStateSerial() != NetGaitSerial)
+	{
+		NetGaitSerial = SpiderCharacter->GetGaitStateSerial();
+		Inputs.NetGait = SpiderCharacter->GetGaitState();
+		Inputs.bHasNewNetGait = true;
+
+		// The server sent the update about half a round trip ago, its phase is extrapolated from then
+		const APlayerController* LocalController = LivingWorld->GetFirstPlayerController();
+		const APlayerState* LocalPlayerState = LocalController ? LocalController->PlayerState.Get() : nullptr;
+		const float Latency = LocalPlayerState ? LocalPlayerState->GetPingInMilliseconds() * 0.0005f : 0.0f;
+		Inputs.NetGaitTime = Inputs.ElapsedTime - Latency;
+	}
+
+	// Over the animation budget, trace and solve less on top of whatever the allocator skips
+	if (SpiderMesh && SpiderMesh->IsWorkReduced())
+		Inputs.TargetLOD = FMath::Max(Inputs.TargetLOD,
+		                              FMath::Min(CVarSpiderRigBudgetReducedLOD.GetValueOnGameThread(), LODs.Num()));
+
+	// Far spiders copy the pose of their leader, they don't need any ground
+	UpdatePoseSharing();
+
+	// Traces need the physics scene, find the ground of every leg ahead of the evaluation
+	if (!Inputs.bIsFalling && !Inputs.bUseSharedPose)
+		ResolveGroundedLegs();
+
+	bHasInputs = true;
+	bHasPreUpdated = true;
+}
+
+void USpiderRig::PostUpdate()
+{
+	check(IsInGameThread());
+	if (!bIsInitialized) return;
+
+	// The evaluation may have changed its LOD on a worker thread, the next LOD is picked from this one
+	GameThreadLOD = Outputs.LOD;
+	bGameThreadLegsFrozen = Outputs.bAreLegsFrozen;
+
+	if (Outputs.bShouldResetVelocity)
+	{
+		CharacterMovementComponent->Velocity = FVector(0, 0, 0);
+		Outputs.bShouldResetVelocity = false;
+	}
+
+	if (!Outputs.LandingRequests.IsEmpty())
+	{
+		SpiderEffects->NotifyFallenAfterJump(Outputs.LandingRequests);
+		Outputs.LandingRequests.Reset();
+	}
+
+	// Hand the pose of this evaluation over to the followers of the bucket
+	if (bHasLeaderPose)
+	{
+		if (PoseSharing)
+			PoseSharing->PublishPose(this, PoseBucketIndex, LeaderPosePhase, LeaderPose);
+		bHasLeaderPose = false;
+	}
+
+	// Only the gait is sent, clients rebuild the legs with their own rig
+	if (bReplicateGait && SpiderCharacter && SpiderCharacter->HasAuthority() &&
+		SpiderCharacter->GetNetMode() != NM_Standalone)
+	{
+		FSpiderGaitNetState GaitState = FSpiderGaitNetState::Quantize(MotorValue, LaggedHorizontalSpeed, JumpImpact,
+		                                                              LandingCount, bIsFalling);
+		if (bReplicateContactHints)
+		{
+			GaitState.bHasContactHints = true;
+			for (int32 i = 0; i < FMath::Min(LegTable.Num(), FSpiderGaitNetState::MaxContactHints); i++)
+			{
+				if (LegTable.StickGroundFactors[i] >= 0.5f)
+					GaitState.LegContacts |= 1 << i;
+			}
+		}
+		SpiderCharacter->SetGaitState(GaitState);
+	}
+}
+
+void USpiderRig::ResolveGroundedLegs()
+{
+	// Frozen legs don't need any ground, only the spine is driven, a new LOD starts a blend which unfreezes them
+	if (bGameThreadLegsFrozen && Inputs.TargetLOD == GameThreadLOD) return;
+
+	const FVector UpVectorWorld = RotateGlobalToWorld(FVector::UpVector);
+	const FVector SpineLocationWorld = TransformGlobalToWorld(InitialSpineLocationGlobal);
+	const int32 TraceInterval = FMath::Max(GetLODDef(Inputs.TargetLOD).TraceInterval, 1);
+	const uint32 EvaluationIndex = GroundEvaluationCounter++;
+
+	// Bring the rest location of every leg into world space in one pass
+	TransformGlobalToWorld(LegTable.RestLocationsGlobal, LegTable.GroundLocationsWorld);
+
+	// Find the leg location on the ground, legs are staggered over the frames on lower LODs
+	for (int32 i = 0; i < LegTable.Num(); i++)
+	{
+		const bool bIsTraceDue = (EvaluationIndex + i) % TraceInterval == 0;
+		ResolveLegGround(i, LegTable.GroundLocationsWorld[i], SpineLocationWorld, UpVectorWorld, bIsTraceDue);
+	}
+
+	// Issue the sweeps of all legs at once, their results are used on the next evaluation
+	if (bUseAsyncTraces)
+		SubmitAsyncLegTraces(UpVectorWorld);
+}
+
+bool USpiderRig::Execute(const FName& InEventName)
+{
+	Super::Execute(InEventName);
+	// If initialization failed, don't bother running the simulation!
+	if (!bIsReady) return false;
+
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(Execute);
+	LLM_SCOPE_BYTAG(SpiderRig);
+	SPIDERRIG_COUNTER_ADD(ExecuteCount, 1);
+
+	// The animation budget only times the mesh tick, evaluations on the workers are reported on top
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	ON_SCOPE_EXIT
+	{
+		if (SpiderMesh && !IsInGameThread())
+			SpiderMesh->AddRigCycles(FPlatformTime::Cycles64() - StartCycles);
+	};
+
+	// The spider mesh updates the rig around its evaluation, anything else has to evaluate on the game thread
+	if (!ParentSceneComponent)
+	{
+		ParentSceneComponent = GetOwningSceneComponent();
+		SpiderMesh = Cast<USpiderMeshComponent>(ParentSceneComponent);
+		if (SpiderMesh)
+			SpiderMesh->SetSpiderRig(this);
+	}
+	const bool bIsSelfUpdated = !bHasPreUpdated && IsInGameThread();
+	if (bIsSelfUpdated)
+		PreUpdate();
+	ON_SCOPE_EXIT
+	{
+		if (bIsSelfUpdated)
+			PostUpdate();
+	};
+
+	// Self-updated or not, the pre-update is counted on its own
+	SPIDERRIG_CYCLE_COUNTER_SCOPE(ExecuteCycles);
+
+	// Without a snapshot there is nothing to evaluate yet
+	if (!bHasInputs) return false;
+	bHasPreUpdated = false;
+
+	// Re-bake the gait when the curves were swapped, in place edits are flagged by the editor hook
+	if (!ToeStickGroundTable.IsBakedFrom(ToeStickGroundTimeline, GaitTableResolution) ||
+		!ToeOffsetTable.IsBakedFrom(ToeOffsetTimeline, GaitTableResolution))
+		BakeGaitTables();
+#if WITH_EDITOR
+	if (bGaitTablesDirty)
+		BakeGaitTables();
+#endif
+	if (!ToeStickGroundTable.IsBaked() || !ToeOffsetTable.IsBaked()) return false;
+
+	// Crowd rigs run one frame behind, commit what the crowd solved for the previous evaluation
+	if (bHasSolvedCrowdFrame)
+	{
+		CommitBoneTransforms();
+		bHasSolvedCrowdFrame = false;
+	}
+
 
 	// Calculate the delta time
-	const float ElapsedTime = LivingWorld->GetTimeSeconds();
+	const float ElapsedTime = Inputs.ElapsedTime;
 	const float RigDeltaTime = ElapsedTime - PrevFrame;
 	PrevFrame = ElapsedTime;
 
+	// Followers copy the pose of their leader, no traces and no IK
+	if (Inputs.bUseSharedPose)
+	{
+		ExecuteSharedPose(RigDeltaTime, ElapsedTime);
+		return true;
+	}
+
+	// Crowd rigs already solve off the game thread one frame behind, they always step per frame
+	if (bUseFixedTimestep && !CrowdSubsystem.IsValid())
+	{
+		ExecuteFixedTimestep(RigDeltaTime, ElapsedTime);
+		CaptureLeaderPose();
+		return true;
+	}
+	bHasFixedStepPose = false;
+
+	// Gather: character state and curve sampling, traces were resolved in the pre-update
+	FSpiderRigFrame Frame;
+	Frame.ElapsedTime = ElapsedTime;
+	Frame.DeltaTime = RigDeltaTime;
+	GatherStep(Frame);
+
+	if (CrowdSubsystem.IsValid())
+	{
+		PendingCrowdFrame = Frame;
+		bHasPendingCrowdFrame = true;
+		return true;
+	}
+
+	// Solve: the spine once, then every leg against the new spine
+	SolveFrame(Frame);
+
+	// Commit: write every bone transform in one pass
+	CommitBoneTransforms();
+	CaptureLeaderPose();
+	return true;
+}
+
+void USpiderRig::BeginDestroy()
+{
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(CurveModifiedHandle);
+	CurveModifiedHandle.Reset();
+#endif
+
+	// The crowd may already be gone when the world is torn down
+	if (USpiderCrowdSubsystem* Crowd = CrowdSubsystem.Get())
+		Crowd->UnregisterRig(this);
+	CrowdSubsystem.Reset();
+	Super::BeginDestroy();
+}
+
+void USpiderRig::SolveCrowdFrame()
+{
+	if (!bHasPendingCrowdFrame) return;
+	LLM_SCOPE_BYTAG(SpiderRig);
+	SPIDERRIG_CYCLE_COUNTER_SCOPE(ExecuteCycles);
+
+	// Crowd solves never run within the mesh tick
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	SolveFrame(PendingCrowdFrame);
+	if (SpiderMesh)
+		SpiderMesh->AddRigCycles(FPlatformTime::Cycles64() - StartCycles);
+	bHasPendingCrowdFrame = false;
+	bHasSolvedCrowdFrame = true;
+}
+
+void USpiderRig::ExecuteFixedTimestep(const float& DeltaTime, const float& ElapsedTime)
+{
+	const float StepTime = 1.0f / FMath::Max(FixedTimestepRate, 1.0f);
+
+	// Start with a step right away, so there is a pose to interpolate from
+	if (!bHasFixedStepPose)
+	{
+		FixedStepAccumulator = StepTime;
+		FixedStepElapsedTime = ElapsedTime - StepTime;
+	}
+	else
+	{
+		FixedStepAccumulator += DeltaTime;
+
+		// Continue the simulation from its own pose, not from the interpolated one
+		if (FixedStepAccumulator >= StepTime)
+			SetFixedStepPose(FixedStepPose);
+	}
+
+	int32 StepCount = 0;
+	while (FixedStepAccumulator >= StepTime && StepCount < FMath::Max(MaxFixedSubSteps, 1))
+	{
+		FixedStepAccumulator -= StepTime;
+		FixedStepElapsedTime += StepTime;
+		StepCount++;
+
+		FSpiderRigFrame Frame;
+		Frame.ElapsedTime = FixedStepElapsedTime;
+		Frame.DeltaTime = StepTime;
+		GatherStep(Frame);
+		SolveFrame(Frame);
+		CommitBoneTransforms();
+
+		Swap(PrevFixedStepPose, FixedStepPose);
+		CaptureFixedStepPose(FixedStepPose);
+		if (!bHasFixedStepPose)
+		{
+			PrevFixedStepPose = FixedStepPose;
+			bHasFixedStepPose = true;
+		}
+	}
+
+	// Drop the time we couldn't catch up with, so a long hitch doesn't keep the rig behind
+	FixedStepAccumulator = FMath::Min(FixedStepAccumulator, StepTime);
+
+	// Show the pose in between the last two steps
+	const float Alpha = FMath::Clamp(FixedStepAccumulator / StepTime, 0.0f, 1.0f);
+	InterpolatedFixedStepPose.SetNumUninitialized(FixedStepPose.Num(), EAllowShrinking::No);
+	for (int32 i = 0; i < FixedStepPose.Num(); i++)
+		InterpolatedFixedStepPose[i].Blend(PrevFixedStepPose[i], FixedStepPose[i], Alpha);
+	SetFixedStepPose(InterpolatedFixedStepPose);
+}
+
+void USpiderRig::CaptureFixedStepPose(TArray<FTransform>& OutPose) const
+{
+	OutPose.SetNumUninitialized(1 + LegTable.BoneIndices.Num(), EAllowShrinking::No);
+	OutPose[0] = RigHierarchy->GetGlobalTransform(SpineIndex);
+	for (int32 i = 0; i < LegTable.BoneIndices.Num(); i++)
+		OutPose[1 + i] = RigHierarchy->GetGlobalTransform(LegTable.BoneIndices[i]);
+}
+
+void USpiderRig::SetFixedStepPose(const TArray<FTransform>& Pose)
+{
+	if (Pose.Num() != 1 + LegTable.BoneIndices.Num()) return;
+
+	// Same order as the regular commit, the spine carries the legs and only the toes carry their children
+	QueueBoneTransform(SpineIndex, Pose[0], true);
+	for (int32 LegIndex = 0; LegIndex < LegTable.Num(); LegIndex++)
+	{
+		const int32& Length = LegTable.BoneCounts[LegIndex];
+		const int32* BoneIndices = LegTable.GetBoneIndices(LegIndex);
+		const FTransform* LegPose = &Pose[1 + LegTable.BoneOffsets[LegIndex]];
+		for (int32 i = 0; i < Length; i++)
+			QueueBoneTransform(BoneIndices[i], LegPose[i], i == Length - 1);
+	}
+	CommitBoneTransforms();
+}
+
+void USpiderRig::UpdatePoseSharing()
+{
+	Inputs.bUseSharedPose = false;
+	PoseRole = ESpiderPoseRole::None;
+	if (bUsePoseSharing != (PoseSharing != nullptr))
+		PoseSharing = bUsePoseSharing ? LivingWorld->GetSubsystem<USpiderPoseSharingSubsystem>() : nullptr;
+	if (!PoseSharing) return;
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(PoseSharing);
+
+	// Same speed as the gather phase reads
+	const float HorizontalSpeed = FMath::Clamp(
+		RotateWorldToGlobal(Inputs.VelocityWorld).Size2D() / FMath::Max(Inputs.MaxWalkSpeed, 1.0f), 0.0f, 1.0f);
+	const ESpiderGaitBucket Gait = USpiderPoseSharingSubsystem::ClassifyGait(HorizontalSpeed, Inputs.bIsFalling);
+
+	// Crowd rigs commit a frame late, their pose would be recorded at the wrong phase
+	PoseRole = PoseSharing->RequestRole(this, Gait, Inputs.TargetLOD, !CrowdSubsystem.IsValid(), PoseBucketIndex);
+	if (PoseRole == ESpiderPoseRole::Leader)
+	{
+		// The followers copy whatever it records, frozen or coarse legs would be copied along
+		Inputs.TargetLOD = 0;
+		SPIDERRIG_INC_COUNTER_BY(PoseLeaders, 1);
+		return;
+	}
+	if (PoseRole != ESpiderPoseRole::Follower) return;
+
+	// The phase the motor reaches this evaluation, every follower keeps its own so they don't march in step
+	const float DeltaTime = Inputs.ElapsedTime - PrevFrame;
+	const float Phase = FMath::Frac(MotorValue + HorizontalSpeed * DeltaTime * ThrottleMultiplier);
+	Inputs.bUseSharedPose = PoseSharing->SamplePose(PoseBucketIndex, Phase, SharedPose);
+	if (Inputs.bUseSharedPose)
+	{
+		SPIDERRIG_INC_COUNTER_BY(SharedPoses, 1);
+	}
+}
+
+void USpiderRig::ExecuteSharedPose(const float& DeltaTime, const float& ElapsedTime)
+{
+	// Keep the gait running, so the spider picks up from its own phase once it evaluates on its own again
+	FSpiderRigFrame Frame;
+	Frame.ElapsedTime = ElapsedTime;
+	Frame.DeltaTime = DeltaTime;
+	GatherFrame(Frame);
+
+	// Falls and landings still count, the effects and the replicated landing count don't know about sharing.
+	// The shared legs aren't planted anywhere, only the spine lands.
+	if (Frame.bIsAirborne)
+		GatherFallStart(Frame);
+	else if (bIsFalling)
+		GatherLanding(Frame, TransformGlobalToWorld(Frame.SpineLocationGlobal));
+	bIsFalling = Frame.bIsAirborne;
+
+	// The legs kept still while the spider moved, they are planted again once it evaluates on its own
+	bAreLegsStale = true;
+
+	SetFixedStepPose(SharedPose);
+	bHasFixedStepPose = false;
+}
+
+void USpiderRig::CaptureLeaderPose()
+{
+	if (PoseRole != ESpiderPoseRole::Leader) return;
+
+	// Fixed timestep rigs show an interpolated pose, the last step is the one matching the motor
+	if (bHasFixedStepPose)
+		LeaderPose = FixedStepPose;
+	else
+		CaptureFixedStepPose(LeaderPose);
+	LeaderPosePhase = FMath::Frac(MotorValue);
+	bHasLeaderPose = true;
+}
+
+void USpiderRig::GatherStep(FSpiderRigFrame& Frame)
+{
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(Gather);
+	GatherFrame(Frame);
+	if (Frame.bIsAirborne)
+		GatherFallingLegs(Frame);
+	else
+		GatherGroundedLegs(Frame);
+	bIsFalling = Frame.bIsAirborne;
+}
+
+void USpiderRig::GatherFrame(FSpiderRigFrame& Frame)
+{
+	const float ElapsedTime = Frame.ElapsedTime;
+	const float RigDeltaTime = Frame.DeltaTime;
+
 
-	
 	// Calculate local velocity
-	FVector LocalVelocity = RotateWorldToGlobal(CharacterMovementComponent->Velocity);
-	float HorizontalSpeed = FMath::Clamp(LocalVelocity.Size2D() / CharacterMovementComponent->MaxWalkSpeed, 0, 1);
-	float VerticalSpeed = LocalVelocity.Z;
+	FVector LocalVelocity = RotateWorldToGlobal(Inputs.VelocityWorld);
+	const float HorizontalSpeed = FMath::Clamp(LocalVelocity.Size2D() / Inputs.MaxWalkSpeed, 0, 1);
+	const float VerticalSpeed = LocalVelocity.Z;
+	Frame.HorizontalSpeed = HorizontalSpeed;
+	Frame.VerticalSpeed = VerticalSpeed;
+
 
-	
-	const bool bIsPawnControlled = ParentCharacter->IsPawnControlled();
+	// The movement component belongs to the game thread, the reset is applied in the post-update
+	const bool bIsPawnControlled = Inputs.bIsPawnControlled;
 	if (bIsControlled && !bIsPawnControlled)
-		CharacterMovementComponent->Velocity = FVector(0, 0, 0);
+		Outputs.bShouldResetVelocity = true;
 	bIsControlled = bIsPawnControlled;
 
 	// If moving, setup movement timestamp, to smoothly transition between different steps
@@ -184,6 +763,7 @@ bool USpiderRig::Execute(const FName& InEventName)
 	LocalVelocity.Normalize();
 	LocalVelocity *= VerticalSpeed * FallingRotationZSpeedCoefficient * -1.0f;
 	LocalVelocity.Z = 0;
+	Frame.LocalVelocity = LocalVelocity;
 	const float& Pitch = FMath::Clamp(LocalVelocity.X, -FallingRotationLimit, FallingRotationLimit);
 	const float& Roll = FMath::Clamp(-LocalVelocity.Y, -FallingRotationLimit, FallingRotationLimit);
 	const FRotator Rotator = FRotator(Pitch, 0, Roll);
@@ -192,8 +772,8 @@ bool USpiderRig::Execute(const FName& InEventName)
 	// Calculate timeline for movement and stall state transition 
 	const float MovementTransitionTimeframe =
 		(LastMovementTimestamp + MovementTransitionDuration - ElapsedTime) / MovementTransitionDuration;
-	float OneOnMovement = FMath::Clamp(MovementTransitionTimeframe, 0.0f, 1.0f);
-	float OneOnStall = 1.0f - OneOnMovement;
+	Frame.OneOnMovement = FMath::Clamp(MovementTransitionTimeframe, 0.0f, 1.0f);
+	Frame.OneOnStall = 1.0f - Frame.OneOnMovement;
 
 
 	// Calculate motor value to feed it into the curves
@@ -204,135 +784,411 @@ bool USpiderRig::Execute(const FName& InEventName)
 		LaggedHorizontalSpeed,
 		HorizontalSpeed,
 		RigDeltaTime,
-		LazyLag + (OneOnStall * LazyStallLagMultiplier)
+		LazyLag + (Frame.OneOnStall * LazyStallLagMultiplier)
 	);
 
+	Frame.bIsAirborne = Inputs.bIsFalling;
+	Frame.SpineLocationGlobal = InitialSpineLocationGlobal;
+	Frame.SpineDeltaTime = RigDeltaTime * SpineSpringLag;
+	Frame.EvaluationIndex = EvaluationCounter++;
+
+	if (Inputs.bIsNetDriven)
+		GatherNetGait(Frame);
+	GatherLOD(Frame);
+}
 
-	FVector SpineLocationGlobal = InitialSpineLocationGlobal;
-	if (CharacterMovementComponent->IsFalling())
+void USpiderRig::GatherNetGait(const FSpiderRigFrame& Frame)
+{
+	// The gait keeps running locally from the replicated movement, an update only tells how far off it is
+	if (Inputs.bHasNewNetGait)
 	{
-		if (VerticalSpeed < 0.0f)
+		const FSpiderGaitNetState& NetGait = Inputs.NetGait;
+		Inputs.bHasNewNetGait = false;
+
+		// The server's gait kept running since it was sent, shortest way around the cycle
+		const float NetGaitAge = FMath::Max(Frame.ElapsedTime - Inputs.NetGaitTime, 0.0f);
+		const float NetMotorPhase = NetGait.GetMotorPhase() +
+			NetGait.GetHorizontalSpeed() * NetGaitAge * ThrottleMultiplier;
+		NetPhaseError = NetMotorPhase - FMath::Frac(MotorValue);
+		NetPhaseError -= FMath::RoundToFloat(NetPhaseError);
+		NetSpeedError = NetGait.GetHorizontalSpeed() - LaggedHorizontalSpeed;
+
+		// The server landed in between two updates without this rig seeing the fall, land here too. The count
+		// stays one short of the server's, the local landing catches it up instead of counting the landing twice
+		const uint8 MissedLandings = (NetGait.LandingCount - LandingCount) & FSpiderGaitNetState::LandingCountMask;
+		if (MissedLandings > 0 && MissedLandings <= FSpiderGaitNetState::LandingCountMask / 2)
 		{
-			if (!bIsFallStarted)
+			LandingCount = (NetGait.LandingCount - 1) & FSpiderGaitNetState::LandingCountMask;
+			if (!bIsFalling && !Frame.bIsAirborne)
 			{
-				JumpZStart = ParentCharacter->GetActorLocation().Z;
-				bIsFallStarted = true;
+				bIsFalling = true;
+				JumpZStart = Inputs.ActorLocationWorld.Z + NetGait.GetLandingImpact();
 			}
 		}
-		bIsFalling = true;
-		SetSpineTransform(SpineLocationGlobal, FinalSpineRotation, RigDeltaTime * SpineSpringLag);
-		for (int i = 0; i < LegLength; i++)
-		{
-			const auto& LegIKIndex = LegIndices[i][0];
-			const auto LegGlobalTransform = RigHierarchy->GetInitialGlobalTransform(LegIKIndex);
+	}
 
-			// Offset the legs while falling to match the character speed 
-			const FVector LegVelocityOffset = LocalVelocity.GetClampedToSize(0.0f, FallingLegOffsetHorizontalLimit);
+	// Close the gap smoothly instead of snapping the legs
+	const float Alpha = 1.0f - FMath::Exp(-NetGaitCorrectionSpeed * Frame.DeltaTime);
+	const float PhaseCorrection = NetPhaseError * Alpha;
+	const float SpeedCorrection = NetSpeedError * Alpha;
+	MotorValue += PhaseCorrection;
+	LaggedHorizontalSpeed = FMath::Clamp(LaggedHorizontalSpeed + SpeedCorrection, 0.0f, 1.0f);
+	NetPhaseError -= PhaseCorrection;
+	NetSpeedError -= SpeedCorrection;
+}
 
-			// spread the legs while falling to make it look like its jumping!
-			const float LegSpreadMultiplier = FMath::Clamp(
-				VerticalSpeed * FallingLegSpreadSpeedCoefficient * -1.0f,
-				FallingMinLegSpread,
-				FallingMaxLegSpread
-			);
+void USpiderRig::GatherLOD(FSpiderRigFrame& Frame)
+{
+	const int32 NewLOD = Inputs.TargetLOD;
+	if (NewLOD != CurrentLOD)
+	{
+		// Blend from wherever the previous blend currently is
+		BlendFromLOD = BlendedLOD;
+		CurrentLOD = NewLOD;
+		LODBlendAlpha = 0.0f;
+	}
 
-			FVector CurrentLegLocation = LegGlobalTransform.GetLocation() * LegSpreadMultiplier + LegVelocityOffset;
+	// The console variable is read in the pre-update, the evaluation may run on a worker
+	const float BlendTime = Inputs.LODBlendTime;
+	LODBlendAlpha = BlendTime > 0.0f ? FMath::Min(LODBlendAlpha + Frame.DeltaTime / BlendTime, 1.0f) : 1.0f;
+
+	// Solver settings blend over time, intervals switch right away since the legs interpolate anyway
+	const FSpiderLODDef TargetLOD = GetLODDef(CurrentLOD);
+	BlendedLOD.IKSolveIteration = FMath::RoundToInt(FMath::Lerp(
+		static_cast<float>(BlendFromLOD.IKSolveIteration),
+		static_cast<float>(TargetLOD.IKSolveIteration),
+		LODBlendAlpha
+	));
+	BlendedLOD.IKPrecision = FMath::Lerp(BlendFromLOD.IKPrecision, TargetLOD.IKPrecision, LODBlendAlpha);
+	BlendedLOD.TraceInterval = FMath::Max(TargetLOD.TraceInterval, 1);
+	BlendedLOD.LegUpdateInterval = FMath::Max(TargetLOD.LegUpdateInterval, 1);
+
+	// Legs only freeze once the blend settled, so they don't stop in the middle of a step
+	BlendedLOD.bFreezeLegs = TargetLOD.bFreezeLegs && LODBlendAlpha >= 1.0f;
+
+	Frame.LOD = CurrentLOD;
+	Frame.LODSettings = BlendedLOD;
+	Outputs.LOD = CurrentLOD;
+	Outputs.bAreLegsFrozen = BlendedLOD.bFreezeLegs;
+}
 
-			// Legs can also go up and down, for more realistic look and feel!
-			CurrentLegLocation.Z = FMath::Clamp(VerticalSpeed * FallingLegLocationCoefficient * -1.0f,
-			                                    FallingMinLegOffset, FallingMaxLegOffset);
+int32 USpiderRig::CalculateLOD() const
+{
+	const int32 MaxLOD = LODs.Num();
+	if (const int32 ForcedLOD = CVarSpiderRigLODForce.GetValueOnGameThread(); ForcedLOD >= 0)
+		return FMath::Min(ForcedLOD, MaxLOD);
+
+	const int32 Mode = CVarSpiderRigLODMode.GetValueOnGameThread();
+	if (Mode <= 0 || MaxLOD == 0) return 0;
+
+	// Find the closest view, without any view (e.g. dedicated servers) stay at full quality
+	const FVector LocationWorld = ParentSceneComponent->GetComponentLocation();
+	float ClosestDistanceSquared = TNumericLimits<float>::Max();
+	float FieldOfView = 90.0f;
+	bool bHasView = false;
+	for (FConstPlayerControllerIterator Iterator = LivingWorld->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		if (!PlayerController || !PlayerController->PlayerCameraManager) continue;
 
-			SetLegLocation(i, CurrentLegLocation, RigDeltaTime * ToeFallingLag);
+		const APlayerCameraManager* CameraManager = PlayerController->PlayerCameraManager;
+		const float DistanceSquared = FVector::DistSquared(CameraManager->GetCameraLocation(), LocationWorld);
+		if (DistanceSquared < ClosestDistanceSquared)
+		{
+			ClosestDistanceSquared = DistanceSquared;
+			FieldOfView = CameraManager->GetFOVAngle();
+			bHasView = true;
 		}
 	}
-	else
+	if (!bHasView) return 0;
+
+	SpiderRigLOD::UpdateThresholds();
+	const float Distance = FMath::Sqrt(ClosestDistanceSquared);
+	const float Hysteresis = FMath::Max(CVarSpiderRigLODHysteresis.GetValueOnGameThread(), 0.0f);
+
+	// Rough fraction of the screen the spider covers
+	const float HalfFieldOfView = FMath::DegreesToRadians(FMath::Clamp(FieldOfView, 1.0f, 170.0f) * 0.5f);
+	const float ScreenSize = ParentSceneComponent->Bounds.SphereRadius /
+		FMath::Max(Distance * FMath::Tan(HalfFieldOfView), UE_KINDA_SMALL_NUMBER);
+
+	const TArray<float>& Thresholds = Mode == 1
+		                                  ? SpiderRigLOD::DistanceThresholds
+		                                  : SpiderRigLOD::ScreenSizeThresholds;
+
+	int32 LOD = 0;
+	for (int32 Tier = 1; Tier <= FMath::Min(MaxLOD, Thresholds.Num()); Tier++)
 	{
-		const FVector UpVectorWorld = RotateGlobalToWorld(FVector::UpVector);
-		const auto SpineLocationWorld = TransformGlobalToWorld(SpineLocationGlobal);
+		// Tiers we are already in need to be crossed back by a margin, so the LOD doesn't flicker
+		const float Margin = Tier <= GameThreadLOD ? 1.0f - Hysteresis : 1.0f + Hysteresis;
+		const float Threshold = Thresholds[Tier - 1];
+		const bool bIsPastThreshold = Mode == 1 ? Distance > Threshold * Margin : ScreenSize < Threshold / Margin;
+		if (!bIsPastThreshold) break;
+		LOD = Tier;
+	}
+	return LOD;
+}
 
-		if (bIsFalling)
+FSpiderLODDef USpiderRig::GetLODDef(const int32& LOD) const
+{
+	// LOD zero is the rig at full quality
+	if (LOD <= 0 || !LODs.IsValidIndex(LOD - 1))
+		return FSpiderLODDef(IKSolveIteration, IKPrecision, 1, 1, false);
+	return LODs[LOD - 1];
+}
+
+void USpiderRig::GatherFallStart(const FSpiderRigFrame& Frame)
+{
+	if (Frame.VerticalSpeed < 0.0f)
+	{
+		if (!bIsFallStarted)
 		{
-			// Reset movement factors on fall
-			OneOnMovement = 0;
-			OneOnStall = 1;
-
-			JumpImpact = FMath::Abs(JumpZStart - ParentCharacter->GetActorLocation().Z);
-			JumpZStart = 0;
-			bIsFallStarted = false;
-			SpiderEffects->NotifyFallenAfterJump(SpineLocationWorld, JumpImpact * 2.0f, false);
+			JumpZStart = Inputs.ActorLocationWorld.Z;
+			bIsFallStarted = true;
 		}
+	}
+}
 
-		for (int i = 0; i < LegLength; i++)
-		{
-			const auto& LegIKIndex = LegIndices[i][0];
-			const auto LegTransformGlobal = RigHierarchy->GetInitialGlobalTransform(LegIKIndex);
-			FVector LegLocationWorld = TransformGlobalToWorld(LegTransformGlobal.GetLocation());
+void USpiderRig::GatherLanding(FSpiderRigFrame& Frame, const FVector& SpineLocationWorld)
+{
+	// Reset movement factors on fall
+	Frame.OneOnMovement = 0;
+	Frame.OneOnStall = 1;
+
+	JumpImpact = FMath::Abs(JumpZStart - Inputs.ActorLocationWorld.Z);
+	JumpZStart = 0;
+	bIsFallStarted = false;
+	LandingCount = (LandingCount + 1) & FSpiderGaitNetState::LandingCountMask;
+	Outputs.LandingRequests.Add({SpineLocationWorld, JumpImpact * 2.0f, false});
+}
 
-			// Find the leg location on the ground
-			TraceSingleLeg(LegLocationWorld, SpineLocationWorld, UpVectorWorld);
+void USpiderRig::GatherFallingLegs(FSpiderRigFrame& Frame)
+{
+	GatherFallStart(Frame);
 
-			// Calculate the time value to evaluate curves
-			const float EvenlyDistributedCycle = i / static_cast<float>(LegLength);
-			const float OffCycleMultiplier = LaggedHorizontalSpeed * AnimationOffCycleCoefficient;
-			const double RepeatedTimeValue =
-				FMath::Frac(MotorValue + (1 - OffCycleMultiplier) * EvenlyDistributedCycle);
+	Frame.LegDeltaTime = Frame.DeltaTime * ToeFallingLag;
+	for (int i = 0; i < LegTable.Num(); i++)
+	{
+		// Offset the legs while falling to match the character speed 
+		const FVector LegVelocityOffset = Frame.LocalVelocity.GetClampedToSize(0.0f, FallingLegOffsetHorizontalLimit);
 
+		// spread the legs while falling to make it look like its jumping!
+		const float LegSpreadMultiplier = FMath::Clamp(
+			Frame.VerticalSpeed * FallingLegSpreadSpeedCoefficient * -1.0f,
+			FallingMinLegSpread,
+			FallingMaxLegSpread
+		);
 
-			// Calculate leg offset
-			const float StickToGroundFactor = ToeStickGroundTimeline->GetFloatValue(RepeatedTimeValue);
-			const float AllowedToRaiseFactor = 1.0f - StickToGroundFactor;
-			const float LegOffsetFactor = ToeOffsetTimeline->GetFloatValue(RepeatedTimeValue);
-			const float LegOffsetCoefficient = FMath::Clamp(LegOffsetFactor * AllowedToRaiseFactor, -2.0f, 2.0f);
-			LegLocationWorld += UpVectorWorld * OneOnMovement * StepHeight * LegOffsetCoefficient;
+		FVector CurrentLegLocation = LegTable.RestLocationsGlobal[i] * LegSpreadMultiplier + LegVelocityOffset;
 
+		// Legs can also go up and down, for more realistic look and feel!
+		CurrentLegLocation.Z = FMath::Clamp(Frame.VerticalSpeed * FallingLegLocationCoefficient * -1.0f,
+		                                    FallingMinLegOffset, FallingMaxLegOffset);
 
-			// Lerp the leg position between its previously grounded location to its current ground location
-			LegLocationsWorld[i] = FMath::Lerp(
-				LegLocationsWorld[i],
-				LegLocationWorld,
-				FMath::Clamp(AllowedToRaiseFactor + OneOnStall, 0.0f, 1.0f)
-			);
+		LegTable.TargetsGlobal[i] = CurrentLegLocation;
+	}
+}
 
+void USpiderRig::GatherGroundedLegs(FSpiderRigFrame& Frame)
+{
+	FVector& SpineLocationGlobal = Frame.SpineLocationGlobal;
+	const FVector UpVectorWorld = RotateGlobalToWorld(FVector::UpVector);
+	const auto SpineLocationWorld = TransformGlobalToWorld(SpineLocationGlobal);
 
-			// Convert calculated leg location to rig space
-			FVector NewLegLocationGlobal = TransformWorldToGlobal(LegLocationsWorld[i]);
+	if (bIsFalling)
+		GatherLanding(Frame, SpineLocationWorld);
+
+	// Frozen legs don't need any ground, only the spine is driven
+	Frame.LegDeltaTime = Frame.DeltaTime * LegMovementLag;
+	if (Frame.LODSettings.bFreezeLegs)
+	{
+		bAreLegsStale = true;
+		return;
+	}
+	if (bAreLegsStale)
+		ReseedLegs();
+
+	// Calculate the time value of every leg to sample the gait
+	const int32 LegCount = LegTable.Num();
+	const float OffCycleMultiplier = LaggedHorizontalSpeed * AnimationOffCycleCoefficient;
+	for (int i = 0; i < LegCount; i++)
+	{
+		const float EvenlyDistributedCycle = i / static_cast<float>(LegCount);
+		LegTable.GaitPhases[i] = FMath::Frac(MotorValue + (1 - OffCycleMultiplier) * EvenlyDistributedCycle);
+	}
 
+	// Sample the baked curves for all legs in one pass
+	{
+		SPIDERRIG_SCOPE_CYCLE_COUNTER(GaitSampling);
+		ToeStickGroundTable.SampleBatch(LegTable.GaitPhases.GetData(), LegTable.StickGroundFactors.GetData(), LegCount);
+		ToeOffsetTable.SampleBatch(LegTable.GaitPhases.GetData(), LegTable.OffsetFactors.GetData(), LegCount);
+	}
 
-			// Calculate mean spine location based on spider legs
-			const float FinalSpineLocationZ = FMath::Max(SpineLocationGlobal.Z, NewLegLocationGlobal.Z);
+	// Legs the server has planted stay planted while the gait is more than a percent of a cycle off, so they
+	// don't slide while it catches up
+	if (Inputs.bIsNetDriven && Inputs.NetGait.bHasContactHints && FMath::Abs(NetPhaseError) > 0.01f)
+	{
+		for (int i = 0; i < FMath::Min(LegCount, FSpiderGaitNetState::MaxContactHints); i++)
+		{
+			if (Inputs.NetGait.LegContacts & 1 << i)
+				LegTable.StickGroundFactors[i] = 1.0f;
+		}
+	}
 
-			// interpolate to its initial location on stall
-			SpineLocationGlobal.Z = FMath::Lerp(
-				InitialSpineLocationGlobal.Z,
-				FinalSpineLocationZ,
-				1.0f - LaggedHorizontalSpeed
-			);
+	for (int i = 0; i < LegCount; i++)
+	{
+		// The ground was found in the pre-update, fixed steps all start from the same ground
+		FVector LegLocationWorld = LegTable.GroundLocationsWorld[i];
+
+		// Calculate leg offset
+		const float StickToGroundFactor = LegTable.StickGroundFactors[i];
+		const float AllowedToRaiseFactor = 1.0f - StickToGroundFactor;
+		const float LegOffsetFactor = LegTable.OffsetFactors[i];
+		const float LegOffsetCoefficient = FMath::Clamp(LegOffsetFactor * AllowedToRaiseFactor, -2.0f, 2.0f);
+		LegLocationWorld += UpVectorWorld * Frame.OneOnMovement * StepHeight * LegOffsetCoefficient;
+
+
+		// Lerp the leg position between its previously grounded location to its current ground location
+		LegTable.LocationsWorld[i] = FMath::Lerp(
+			LegTable.LocationsWorld[i],
+			LegLocationWorld,
+			FMath::Clamp(AllowedToRaiseFactor + Frame.OneOnStall, 0.0f, 1.0f)
+		);
+	}
 
-			// If spider has fallen on the ground, add an extra force, make it look natural
-			if (bIsFalling)
-			{
-				SpineLocationGlobal.Z -= FallingImpactOnSpine;
-				SpiderEffects->NotifyFallenAfterJump(LegLocationsWorld[i], JumpImpact, true);
-			}
+	// Convert calculated leg locations to rig space in one pass
+	TransformWorldToGlobal(LegTable.LocationsWorld, LegTable.TargetsGlobal);
 
-			// Setup bone transforms
-			SetSpineTransform(SpineLocationGlobal, FinalSpineRotation, RigDeltaTime * SpineSpringLag);
-			SetLegLocation(i, NewLegLocationGlobal, RigDeltaTime * LegMovementLag);
+	for (int i = 0; i < LegCount; i++)
+	{
+		// Calculate mean spine location based on spider legs
+		const float FinalSpineLocationZ = FMath::Max(SpineLocationGlobal.Z, LegTable.TargetsGlobal[i].Z);
+
+		// interpolate to its initial location on stall
+		SpineLocationGlobal.Z = FMath::Lerp(
+			InitialSpineLocationGlobal.Z,
+			FinalSpineLocationZ,
+			1.0f - LaggedHorizontalSpeed
+		);
+
+		// If spider has fallen on the ground, add an extra force, make it look natural
+		if (bIsFalling)
+		{
+			SpineLocationGlobal.Z -= FallingImpactOnSpine;
+			Outputs.LandingRequests.Add({LegTable.LocationsWorld[i], JumpImpact, true});
 		}
-		bIsFalling = false;
 	}
-	return true;
+}
+
+void USpiderRig::ReseedLegs()
+{
+	// The spider kept moving while its legs didn't follow the ground, planted legs would stretch back to where
+	// they were. Plant them on the current ground and aim them where they are drawn, so they step from there.
+	for (int32 i = 0; i < LegTable.Num(); i++)
+	{
+		const int32* BoneIndices = LegTable.GetBoneIndices(i);
+		LegTable.LocationsWorld[i] = LegTable.GroundLocationsWorld[i];
+		LegTable.FinalLocationsGlobal[i] =
+			RigHierarchy->GetGlobalTransform(BoneIndices[LegTable.BoneCounts[i] - 1]).GetLocation();
+		LegTable.SolvedState[i] = false;
+	}
+	bAreLegsStale = false;
+}
+
+void USpiderRig::SolveFrame(const FSpiderRigFrame& Frame)
+{
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(Solve);
+	EffectiveIKSolveIteration = Frame.LODSettings.IKSolveIteration;
+	EffectiveIKPrecision = Frame.LODSettings.IKPrecision;
+
+	SetSpineTransform(Frame.SpineLocationGlobal, FinalSpineRotation, Frame.SpineDeltaTime);
+	for (int32 i = 0; i < LegTable.Num(); i++)
+	{
+		// Frozen legs keep their pose, the others take turns on lower LODs
+		const int32& UpdateInterval = Frame.LODSettings.LegUpdateInterval;
+		LegTable.ActiveState[i] = !Frame.LODSettings.bFreezeLegs && (Frame.EvaluationIndex + i) % UpdateInterval == 0;
+
+		// Skipped frames are caught up on the next update, capped so a long freeze doesn't snap the leg
+		float& AccumulatedDeltaTime = LegTable.AccumulatedDeltaTime[i];
+		AccumulatedDeltaTime = FMath::Min(AccumulatedDeltaTime + Frame.LegDeltaTime,
+		                                  Frame.LegDeltaTime * UpdateInterval);
+		if (!LegTable.ActiveState[i]) continue;
+
+		SetLegLocation(i, LegTable.TargetsGlobal[i], AccumulatedDeltaTime);
+		AccumulatedDeltaTime = 0.0f;
+	}
+	if (IKSolver == ESpiderLegSolver::Batched)
+		SolveLegsBatched();
+}
+
+void USpiderRig::SetSpineTransform(const FVector& SpineLocationGlobal, const FRotator& RotationGlobal, const float& Dt)
+{
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(SetSpineTransform);
+	const auto NewLocation = SpineSpringInterpolator.Update(SpineLocationGlobal, Dt);
+	const FTransform SpineTransformGlobal(RotationGlobal.Quaternion(), NewLocation);
+	const FTransform PrevSpineTransformGlobal = RigHierarchy->GetGlobalTransform(SpineIndex);
+	QueueBoneTransform(SpineIndex, SpineTransformGlobal, true);
+
+	// Legs attached to the spine will follow it on commit, move their roots ahead of time
+	for (int32 i = 0; i < LegTable.Num(); i++)
+	{
+		FTransform& RootTransformGlobal = LegTable.RootTransforms[i];
+		RootTransformGlobal = RigHierarchy->GetGlobalTransform(LegTable.GetBoneIndices(i)[0]);
+		if (LegTable.FollowsSpine[i])
+			RootTransformGlobal = RootTransformGlobal.GetRelativeTransform(PrevSpineTransformGlobal) * SpineTransformGlobal;
+	}
 }
 
 void USpiderRig::SetLegLocation(const int32& LegIndex, const FVector& NewLegLocationGlobal, const float& Dt)
 {
-	const int32& Length = LegIndices[LegIndex][1];
-	const int32* BoneIndices = &LegIndices[LegIndex][2];
-	FVector& LegLocationGlobal = FinalLegLocationsGlobal[LegIndex];
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(SetLegLocation);
+	FVector& LegLocationGlobal = LegTable.FinalLocationsGlobal[LegIndex];
 
 	// Interpolate to final leg location
 	LegLocationGlobal = FMath::VInterpTo(LegLocationGlobal, NewLegLocationGlobal, Dt, ToePlacementLagSpeed);
 
+	// Batched solver waits for every leg before solving
+	if (IKSolver == ESpiderLegSolver::CCDIK)
+		SolveLegCCDIK(LegIndex);
+}
+
+bool USpiderRig::ShouldSolveLeg(const int32& LegIndex) const
+{
+	if (!LegTable.ActiveState[LegIndex]) return false;
+	if (!bIKWarmStart || !LegTable.SolvedState[LegIndex]) return true;
+
+	// Skip the solve if the target barely moved relative to the leg root
+	const FVector TargetRelative = LegTable.RootTransforms[LegIndex].InverseTransformPosition(
+		LegTable.FinalLocationsGlobal[LegIndex]);
+	return FVector::DistSquared(TargetRelative, LegTable.SolvedTargets[LegIndex]) >= FMath::Square(IKSkipThreshold);
+}
+
+FTransform USpiderRig::GetLegBoneTransform(const int32& LegIndex, const int32& BoneIndex) const
+{
+	// The root link never rotates, so chains are kept relative to it and follow the spine
+	const FTransform& RootTransformGlobal = LegTable.RootTransforms[LegIndex];
+
+	// Warm start from the previously solved chain
+	if (bIKWarmStart && LegTable.SolvedState[LegIndex])
+		return LegTable.GetSolvedChain(LegIndex)[BoneIndex] * RootTransformGlobal;
+
+	const int32* BoneIndices = LegTable.GetBoneIndices(LegIndex);
+	const FTransform BoneTransform = RigHierarchy->GetGlobalTransform(BoneIndices[BoneIndex]);
+	const FTransform HierarchyRootTransform = RigHierarchy->GetGlobalTransform(BoneIndices[0]);
+	return BoneTransform.GetRelativeTransform(HierarchyRootTransform) * RootTransformGlobal;
+}
+
+void USpiderRig::StoreSolvedLeg(const int32& LegIndex)
+{
+	LegTable.SolvedTargets[LegIndex] = LegTable.RootTransforms[LegIndex].InverseTransformPosition(
+		LegTable.FinalLocationsGlobal[LegIndex]);
+	LegTable.SolvedState[LegIndex] = true;
+}
+
+void USpiderRig::SolveLegCCDIK(const int32& LegIndex)
+{
+	const int32& Length = LegTable.BoneCounts[LegIndex];
+	const int32* BoneIndices = LegTable.GetBoneIndices(LegIndex);
+
 	// Initialize temporary arrays
 	if (TemporaryChain.Num() != Length)
 	{
@@ -340,75 +1196,354 @@ void USpiderRig::SetLegLocation(const int32& LegIndex, const FVector& NewLegLoca
 		RotationLimitsPerItem.SetNum(Length, EAllowShrinking::No);
 	}
 
+	if (!ShouldSolveLeg(LegIndex)) return;
+	SPIDERRIG_COUNTER_ADD(IKSolveCount, 1);
+
 	// Initialize chain with bone transforms
 	for (int32 i = 0; i < Length; i++)
 	{
 		const int& BoneIndex = BoneIndices[i];
-		auto Transform = RigHierarchy->GetGlobalTransform(BoneIndex);
-		auto LocalTransform = RigHierarchy->GetLocalTransform(BoneIndex);
+		auto Transform = GetLegBoneTransform(LegIndex, i);
+		auto LocalTransform = i > 0
+			                      ? Transform.GetRelativeTransform(TemporaryChain[i - 1].Transform)
+			                      : RigHierarchy->GetLocalTransform(BoneIndex);
 		TemporaryChain[i] = FCCDIKChainLink(Transform, LocalTransform, i);
-		RotationLimitsPerItem[i] = 10;
+		RotationLimitsPerItem[i] = IKRotationLimit;
 	}
 
 	// Solve IK using CCD algorithm
 	const bool IsBoneLocationUpdated = AnimationCore::SolveCCDIK(
 		TemporaryChain,
-		LegLocationGlobal,
-		IKPrecision,
-		IKSolveIteration,
+		LegTable.FinalLocationsGlobal[LegIndex],
+		EffectiveIKPrecision,
+		EffectiveIKSolveIteration,
 		true,
 		false,
 		RotationLimitsPerItem
 	);
 
+	// Keep the solved chain to warm start the next solve
+	FTransform* SolvedChain = LegTable.GetSolvedChain(LegIndex);
+	for (int32 i = 0; i < Length; i++)
+		SolvedChain[i] = TemporaryChain[i].Transform.GetRelativeTransform(LegTable.RootTransforms[LegIndex]);
+	StoreSolvedLeg(LegIndex);
+
 	if (!IsBoneLocationUpdated) return;
 
-	// Update bone transforms if they have to move
+	// Update bone transforms if they have to move, only the toe has to carry its children
 	for (int i = 0; i < Length; i++)
 	{
 		const int& BoneIndex = BoneIndices[i];
 		const FCCDIKChainLink& CurrentLink = TemporaryChain[i];
-		RigHierarchy->SetGlobalTransform(BoneIndex, CurrentLink.Transform, true);
+		QueueBoneTransform(BoneIndex, CurrentLink.Transform, i == Length - 1);
 	}
 }
 
-void USpiderRig::SetSpineTransform(const FVector& SpineLocationGlobal, const FRotator& RotationGlobal, const float& Dt)
+void USpiderRig::SolveLegsBatched()
 {
-	const auto NewLocation = SpineSpringInterpolator.Update(SpineLocationGlobal, Dt);
-	RigHierarchy->SetGlobalTransform(SpineIndex, FTransform(RotationGlobal.Quaternion(), NewLocation), true);
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(SolveLegsBatched);
+	// Inactive, frozen and barely moved legs keep their previous pose
+	bool bHasLegToSolve = false;
+	for (int32 LegIndex = 0; LegIndex < LegTable.Num(); LegIndex++)
+	{
+		LegTable.SolveState[LegIndex] = ShouldSolveLeg(LegIndex);
+		bHasLegToSolve |= LegTable.SolveState[LegIndex];
+	}
+	if (!bHasLegToSolve) return;
+
+	// Pack only the legs to solve, the others aim at whatever their lane holds so it stays idle
+	for (int32 LegIndex = 0; LegIndex < LegTable.Num(); LegIndex++)
+	{
+		if (!LegTable.SolveState[LegIndex])
+		{
+			LegSolver.SkipLeg(LegIndex);
+			continue;
+		}
+
+		const int32& Length = LegTable.BoneCounts[LegIndex];
+		for (int32 i = 0; i < Length; i++)
+			LegSolver.SetBone(LegIndex, i, GetLegBoneTransform(LegIndex, i), IKRotationLimit);
+		LegSolver.PadChain(LegIndex, Length);
+		LegSolver.SetTarget(LegIndex, LegTable.FinalLocationsGlobal[LegIndex]);
+	}
+
+	const int32 IterationCount = LegSolver.Solve(EffectiveIKPrecision, EffectiveIKSolveIteration);
+	SPIDERRIG_INC_BENCHMARK_COUNTER_BY(IKIterations, IterationCount);
+
+	// Update bone transforms of the legs which had to move, only the toe has to carry its children
+	for (int32 LegIndex = 0; LegIndex < LegTable.Num(); LegIndex++)
+	{
+		if (!LegTable.SolveState[LegIndex]) continue;
+		SPIDERRIG_COUNTER_ADD(IKSolveCount, 1);
+
+		const int32& Length = LegTable.BoneCounts[LegIndex];
+		const int32* BoneIndices = LegTable.GetBoneIndices(LegIndex);
+		const bool bIsUpdated = LegSolver.IsLegUpdated(LegIndex);
+		FTransform* SolvedChain = LegTable.GetSolvedChain(LegIndex);
+
+		for (int32 i = 0; i < Length; i++)
+		{
+			const FTransform BoneTransform = LegSolver.GetBoneTransform(LegIndex, i);
+			SolvedChain[i] = BoneTransform.GetRelativeTransform(LegTable.RootTransforms[LegIndex]);
+			if (bIsUpdated)
+				QueueBoneTransform(BoneIndices[i], BoneTransform, i == Length - 1);
+		}
+		StoreSolvedLeg(LegIndex);
+	}
 }
 
+void USpiderRig::QueueBoneTransform(const int32& BoneIndex, const FTransform& TransformGlobal,
+                                    const bool& bAffectChildren)
+{
+	FSpiderBoneWrite& BoneWrite = BoneWrites.AddDefaulted_GetRef();
+	BoneWrite.BoneIndex = BoneIndex;
+	BoneWrite.TransformGlobal = TransformGlobal;
+	BoneWrite.bAffectChildren = bAffectChildren;
+}
 
-bool USpiderRig::TraceSingleLeg(FVector& LegLocationWorld, const FVector& RootLocationWorld,
-                                const FVector& UpVectorWorld) const
+void USpiderRig::CommitBoneTransforms()
+{
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(Commit);
+	// Writes are queued parent first: the spine carries every leg along, leg bones are all written
+	// explicitly so they don't have to dirty their children again
+	for (const FSpiderBoneWrite& BoneWrite : BoneWrites)
+		RigHierarchy->SetGlobalTransform(BoneWrite.BoneIndex, BoneWrite.TransformGlobal, BoneWrite.bAffectChildren);
+
+	BoneWrites.Reset();
+}
+
+void USpiderRig::TransformGlobalToWorld(const TArray<FVector>& LocationsGlobal, TArray<FVector>& OutLocationsWorld) const
+{
+	const FMatrix GlobalToWorld = Inputs.ComponentTransform.ToMatrixWithScale();
+	OutLocationsWorld.SetNumUninitialized(LocationsGlobal.Num(), EAllowShrinking::No);
+	for (int32 i = 0; i < LocationsGlobal.Num(); i++)
+		OutLocationsWorld[i] = GlobalToWorld.TransformPosition(LocationsGlobal[i]);
+}
+
+void USpiderRig::TransformWorldToGlobal(const TArray<FVector>& LocationsWorld, TArray<FVector>& OutLocationsGlobal) const
+{
+	// Invert once instead of dividing by the scale for every point
+	const FMatrix WorldToGlobal = Inputs.ComponentTransform.ToInverseMatrixWithScale();
+	OutLocationsGlobal.SetNumUninitialized(LocationsWorld.Num(), EAllowShrinking::No);
+	for (int32 i = 0; i < LocationsWorld.Num(); i++)
+		OutLocationsGlobal[i] = WorldToGlobal.TransformPosition(LocationsWorld[i]);
+}
+
+void USpiderRig::CalculateLegTrace(const FVector& LegLocationWorld, const FVector& RootLocationWorld,
+                                   const FVector& UpVectorWorld, FVector& TraceOriginWorld,
+                                   FVector& TraceEndWorld) const
 {
 	FVector TraceDirection = (LegLocationWorld - (RootLocationWorld + UpVectorWorld * ToeTraceOriginUpward));
 	TraceDirection.Normalize();
 
 	// A ray-cast from Head to Toe
-	const FVector TraceOriginWorld = LegLocationWorld - TraceDirection * ToeTraceDepthInward;
-	const FVector TraceEndWorld = LegLocationWorld + TraceDirection * ToeTraceDepthOutward;
+	TraceOriginWorld = LegLocationWorld - TraceDirection * ToeTraceDepthInward;
+	TraceEndWorld = LegLocationWorld + TraceDirection * ToeTraceDepthOutward;
+}
+
+bool USpiderRig::TraceSingleLeg(FVector& LegLocationWorld, const FVector& RootLocationWorld,
+                                const FVector& UpVectorWorld, FHitResult& HitResult, bool& bOutIsLedge) const
+{
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(TraceSingleLeg);
+	bOutIsLedge = false;
 
-	FCollisionQueryParams Params;
-	Params.AddIgnoredActor(ParentActor);
-	const FCollisionShape SphereCollisionShape = FCollisionShape::MakeSphere(ToeTraceRadius);
-	FHitResult HitResult;
+	FVector TraceOriginWorld, TraceEndWorld;
+	CalculateLegTrace(LegLocationWorld, RootLocationWorld, UpVectorWorld, TraceOriginWorld, TraceEndWorld);
+
+	SPIDERRIG_INC_BENCHMARK_COUNTER_BY(SweepsIssued, 1);
 	if (LivingWorld->SweepSingleByChannel(HitResult, TraceOriginWorld, TraceEndWorld, FQuat::Identity, ECC_Visibility,
-	                                      SphereCollisionShape, Params))
+	                                      TraceCollisionShape, TraceQueryParams))
 	{
+		SPIDERRIG_INC_COUNTER_BY(SweepsHit, 1);
 		LegLocationWorld = HitResult.ImpactPoint;
 		return true;
 	}
+	SPIDERRIG_INC_COUNTER_BY(SweepsMissed, 1);
 
 	// If unsuccessful, try grabbing a ledge
 	// A ray-cast from Toe to Spine
+	SPIDERRIG_INC_BENCHMARK_COUNTER_BY(SweepsIssued, 1);
 	if (LivingWorld->SweepSingleByChannel(
 		HitResult,
-		HitResult.TraceEnd, RootLocationWorld, FQuat::Identity, ECC_Visibility, SphereCollisionShape,
-		Params))
+		HitResult.TraceEnd, RootLocationWorld, FQuat::Identity, ECC_Visibility, TraceCollisionShape,
+		TraceQueryParams))
 	{
+		SPIDERRIG_INC_COUNTER_BY(SweepsHit, 1);
+		SPIDERRIG_INC_COUNTER_BY(LedgeFallbacks, 1);
 		LegLocationWorld = HitResult.ImpactPoint;
+		bOutIsLedge = true;
 		return true;
 	}
+	SPIDERRIG_INC_COUNTER_BY(SweepsMissed, 1);
 	return false;
 }
+
+bool USpiderRig::ResolveFootholdLegGround(FSpiderLegTrace& Trace, const FVector& LegLocationWorld,
+                                          const FVector& RootLocationWorld, const FVector& UpVectorWorld) const
+{
+	if (!FootholdSubsystem || !FootholdSubsystem->HasMaps()) return false;
+
+	FVector TraceOriginWorld, TraceEndWorld;
+	CalculateLegTrace(LegLocationWorld, RootLocationWorld, UpVectorWorld, TraceOriginWorld, TraceEndWorld);
+
+	FSpiderFoothold Foothold;
+	if (!FootholdSubsystem->FindFoothold(TraceOriginWorld, TraceEndWorld, ToeTraceRadius, Foothold)) return false;
+
+	// Drop whatever is still in flight for this leg, the footholds already answered
+	Trace.GroundHandle = FTraceHandle();
+	Trace.LedgeHandle = FTraceHandle();
+	Trace.bShouldSubmit = false;
+
+	// Same as the sweeps, past the edge of a ledge the leg grabs the edge itself
+	Trace.bHasGround = true;
+	Trace.GroundOffsetWorld = Foothold.Location - LegLocationWorld;
+	Trace.LedgeLocationWorld = Foothold.Location;
+	Trace.bIsLedge = Foothold.bIsLedge;
+	SPIDERRIG_INC_COUNTER_BY(LedgeFallbacks, Foothold.bIsLedge ? 1 : 0);
+	return true;
+}
+
+bool USpiderRig::ResolveCachedLegGround(FSpiderLegTrace& Trace, const FVector& LegLocationWorld,
+                                        const FVector& RootLocationWorld, const FVector& UpVectorWorld) const
+{
+	if (!GroundCache) return false;
+
+	FVector TraceOriginWorld, TraceEndWorld;
+	CalculateLegTrace(LegLocationWorld, RootLocationWorld, UpVectorWorld, TraceOriginWorld, TraceEndWorld);
+
+	FVector GroundLocationWorld;
+	bool bHasGround = false;
+	if (!GroundCache->FindGround(LegLocationWorld, TraceOriginWorld, TraceEndWorld, GroundLocationWorld, bHasGround))
+		return false;
+
+	// Drop whatever is still in flight for this leg, the cache already answered
+	Trace.GroundHandle = FTraceHandle();
+	Trace.LedgeHandle = FTraceHandle();
+	Trace.bShouldSubmit = false;
+
+	// A cached miss still gets the ledge sweep, ledges are only valid for the leg which grabbed them
+	Trace.bShouldSweepLedge = !bHasGround;
+	if (!bHasGround) return false;
+
+	Trace.bHasGround = true;
+	Trace.GroundOffsetWorld = GroundLocationWorld - LegLocationWorld;
+	Trace.bIsLedge = false;
+	return true;
+}
+
+bool USpiderRig::ResolveLegGround(const int32& LegIndex, FVector& LegLocationWorld, const FVector& RootLocationWorld,
+                                  const FVector& UpVectorWorld, const bool& bIsTraceDue)
+{
+	FSpiderLegTrace& Trace = LegTable.Traces[LegIndex];
+
+	if (bUseAsyncTraces)
+	{
+		// Collect the sweeps issued on a previous evaluation, if they are not available yet
+		// keep using the last known ground offset
+		FTraceDatum TraceDatum;
+		if (LivingWorld->QueryTraceData(Trace.GroundHandle, TraceDatum))
+		{
+			const FHitResult* HitResult = FHitResult::GetFirstBlockingHit(TraceDatum.OutHits);
+			const bool bIsGroundHit = HitResult != nullptr;
+			SPIDERRIG_INC_COUNTER_BY(SweepsHit, HitResult ? 1 : 0);
+			SPIDERRIG_INC_COUNTER_BY(SweepsMissed, HitResult ? 0 : 1);
+
+			// Fallback to the ledge sweep, only issued along with the ground sweep after a previous miss
+			Trace.bShouldSweepLedge = !bIsGroundHit;
+			if (!HitResult && LivingWorld->QueryTraceData(Trace.LedgeHandle, TraceDatum))
+			{
+				HitResult = FHitResult::GetFirstBlockingHit(TraceDatum.OutHits);
+				SPIDERRIG_INC_COUNTER_BY(SweepsHit, HitResult ? 1 : 0);
+				SPIDERRIG_INC_COUNTER_BY(SweepsMissed, HitResult ? 0 : 1);
+				SPIDERRIG_INC_COUNTER_BY(LedgeFallbacks, HitResult ? 1 : 0);
+			}
+
+			Trace.bHasGround = HitResult != nullptr;
+			Trace.bIsLedge = HitResult && !bIsGroundHit;
+			if (HitResult)
+			{
+				Trace.GroundOffsetWorld = HitResult->ImpactPoint - Trace.RequestedLocationWorld;
+				Trace.LedgeLocationWorld = HitResult->ImpactPoint;
+			}
+
+			// Ledges only hold for the leg which grabbed them, share ground hits and misses
+			if (GroundCache && (!HitResult || bIsGroundHit))
+				GroundCache->StoreGround(Trace.RequestedLocationWorld, Trace.TraceOriginWorld, Trace.TraceEndWorld,
+				                         HitResult);
+
+			Trace.GroundHandle = FTraceHandle();
+			Trace.LedgeHandle = FTraceHandle();
+		}
+	}
+
+	if (!bIsTraceDue)
+	{
+		// Keep the last result until the next trace is due
+	}
+	else if (ResolveFootholdLegGround(Trace, LegLocationWorld, RootLocationWorld, UpVectorWorld))
+	{
+		// Static ground baked offline
+	}
+	else if (ResolveCachedLegGround(Trace, LegLocationWorld, RootLocationWorld, UpVectorWorld))
+	{
+		// Another spider already swept here
+	}
+	else if (bUseAsyncTraces)
+	{
+		// Remember where to sweep from, the sweeps are submitted together with the other legs
+		Trace.RequestedLocationWorld = LegLocationWorld;
+		Trace.RootLocationWorld = RootLocationWorld;
+		Trace.bShouldSubmit = true;
+	}
+	else
+	{
+		FVector GroundLocationWorld = LegLocationWorld;
+		FHitResult HitResult;
+		bool bIsLedge = false;
+		Trace.bHasGround = TraceSingleLeg(GroundLocationWorld, RootLocationWorld, UpVectorWorld, HitResult, bIsLedge);
+		Trace.GroundOffsetWorld = GroundLocationWorld - LegLocationWorld;
+		Trace.LedgeLocationWorld = GroundLocationWorld;
+		Trace.bIsLedge = bIsLedge;
+
+		if (GroundCache && !bIsLedge)
+		{
+			FVector TraceOriginWorld, TraceEndWorld;
+			CalculateLegTrace(LegLocationWorld, RootLocationWorld, UpVectorWorld, TraceOriginWorld, TraceEndWorld);
+			GroundCache->StoreGround(LegLocationWorld, TraceOriginWorld, TraceEndWorld,
+			                         Trace.bHasGround ? &HitResult : nullptr);
+		}
+	}
+
+	// Carry the last hit over to the current leg location, so the legs aren't dragged behind between traces,
+	// a ledge only holds where it was grabbed
+	if (!Trace.bHasGround) return false;
+	LegLocationWorld = Trace.bIsLedge ? Trace.LedgeLocationWorld : LegLocationWorld + Trace.GroundOffsetWorld;
+	return true;
+}
+
+void USpiderRig::SubmitAsyncLegTraces(const FVector& UpVectorWorld)
+{
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(SubmitAsyncTraces);
+	for (int32 i = 0; i < LegTable.Num(); i++)
+	{
+		FSpiderLegTrace& Trace = LegTable.Traces[i];
+		if (!Trace.bShouldSubmit) continue;
+		Trace.bShouldSubmit = false;
+
+		// Kept for the ground cache, the result is stored against the sweep it came from
+		CalculateLegTrace(Trace.RequestedLocationWorld, Trace.RootLocationWorld, UpVectorWorld,
+		                  Trace.TraceOriginWorld, Trace.TraceEndWorld);
+
+		Trace.GroundHandle = LivingWorld->AsyncSweepByChannel(
+			EAsyncTraceType::Single, Trace.TraceOriginWorld, Trace.TraceEndWorld, FQuat::Identity, ECC_Visibility,
+			TraceCollisionShape, TraceQueryParams);
+		SPIDERRIG_INC_BENCHMARK_COUNTER_BY(SweepsIssued, 1);
+
+		// The ledge sweep can't wait for the ground result, legs which just missed the ground get it in the same batch
+		if (!Trace.bShouldSweepLedge) continue;
+		Trace.LedgeHandle = LivingWorld->AsyncSweepByChannel(
+			EAsyncTraceType::Single, Trace.TraceEndWorld, Trace.RootLocationWorld, FQuat::Identity, ECC_Visibility,
+			TraceCollisionShape, TraceQueryParams);
+		SPIDERRIG_INC_BENCHMARK_COUNTER_BY(SweepsIssued, 1);
+	}
+}
@@ -0,0 +1,21 @@
+#include "SpiderRigCounters.h"
+
+#if SPIDERRIG_WITH_COUNTERS
+
+FSpiderRigCounters& FSpiderRigCounters::Get()
+{
+	static FSpiderRigCounters Counters;
+	return Counters;
+}
+
+void FSpiderRigCounters::Reset()
+{
+	ExecuteCycles = 0;
+	ExecuteCount = 0;
+	PreUpdateCycles = 0;
+	SweepsIssued = 0;
+	IKIterations = 0;
+	IKSolveCount = 0;
+}
+
+#endif
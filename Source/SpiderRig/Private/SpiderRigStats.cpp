@@ -0,0 +1,45 @@
+#include "SpiderRigStats.h"
+
+DEFINE_STAT(STAT_SpiderRig_Execute);
+DEFINE_STAT(STAT_SpiderRig_PreUpdate);
+DEFINE_STAT(STAT_SpiderRig_Gather);
+DEFINE_STAT(STAT_SpiderRig_GaitSampling);
+DEFINE_STAT(STAT_SpiderRig_Solve);
+DEFINE_STAT(STAT_SpiderRig_Commit);
+DEFINE_STAT(STAT_SpiderRig_TraceSingleLeg);
+DEFINE_STAT(STAT_SpiderRig_SubmitAsyncTraces);
+DEFINE_STAT(STAT_SpiderRig_SetLegLocation);
+DEFINE_STAT(STAT_SpiderRig_SetSpineTransform);
+DEFINE_STAT(STAT_SpiderRig_SolveLegsBatched);
+DEFINE_STAT(STAT_SpiderRig_FindFoothold);
+DEFINE_STAT(STAT_SpiderRig_PoseSharing);
+
+DEFINE_STAT(STAT_SpiderRig_CameraUpdate);
+DEFINE_STAT(STAT_SpiderRig_CameraCollision);
+DEFINE_STAT(STAT_SpiderRig_CameraZones);
+DEFINE_STAT(STAT_SpiderRig_EffectSpawn);
+DEFINE_STAT(STAT_SpiderRig_EffectBudget);
+
+DEFINE_STAT(STAT_SpiderRig_SwarmGait);
+DEFINE_STAT(STAT_SpiderRig_SwarmUpdate);
+
+DEFINE_STAT(STAT_SpiderRig_SweepsIssued);
+DEFINE_STAT(STAT_SpiderRig_SweepsHit);
+DEFINE_STAT(STAT_SpiderRig_SweepsMissed);
+DEFINE_STAT(STAT_SpiderRig_LedgeFallbacks);
+DEFINE_STAT(STAT_SpiderRig_IKIterations);
+DEFINE_STAT(STAT_SpiderRig_EffectSpawns);
+DEFINE_STAT(STAT_SpiderRig_EffectRequests);
+DEFINE_STAT(STAT_SpiderRig_EffectsDropped);
+DEFINE_STAT(STAT_SpiderRig_GroundCacheHits);
+DEFINE_STAT(STAT_SpiderRig_GroundCacheMisses);
+DEFINE_STAT(STAT_SpiderRig_FootholdHits);
+DEFINE_STAT(STAT_SpiderRig_FootholdMisses);
+DEFINE_STAT(STAT_SpiderRig_SwarmPromotions);
+DEFINE_STAT(STAT_SpiderRig_SwarmDemotions);
+DEFINE_STAT(STAT_SpiderRig_SharedPoses);
+DEFINE_STAT(STAT_SpiderRig_PoseLeaders);
+
+CSV_DEFINE_CATEGORY_MODULE(SPIDERRIG_API, SpiderRig, true);
+
+LLM_DEFINE_TAG(SpiderRig);
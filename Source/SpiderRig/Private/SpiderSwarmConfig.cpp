@@ -0,0 +1,17 @@
+#include "SpiderSwarmConfig.h"
+
+#include "Curves/CurveFloat.h"
+
+void USpiderSwarmConfig::BakeGaitTables()
+{
+#if WITH_EDITOR
+	// Curves may have been edited in place since the last swarm was spawned, baking is cheap next to spawning
+	ToeStickGroundTable.Bake(ToeStickGroundTimeline, GaitTableResolution);
+	ToeOffsetTable.Bake(ToeOffsetTimeline, GaitTableResolution);
+#else
+	if (!ToeStickGroundTable.IsBakedFrom(ToeStickGroundTimeline, GaitTableResolution))
+		ToeStickGroundTable.Bake(ToeStickGroundTimeline, GaitTableResolution);
+	if (!ToeOffsetTable.IsBakedFrom(ToeOffsetTimeline, GaitTableResolution))
+		ToeOffsetTable.Bake(ToeOffsetTimeline, GaitTableResolution);
+#endif
+}
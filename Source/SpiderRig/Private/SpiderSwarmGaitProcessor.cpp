@@ -0,0 +1,132 @@
+#include "SpiderSwarmGaitProcessor.h"
+
+#include "MassCommonFragments.h"
+#include "MassExecutionContext.h"
+#include "SpiderRigStats.h"
+#include "SpiderSwarmConfig.h"
+#include "SpiderSwarmFragments.h"
+
+namespace SpiderSwarmGait
+{
+	// Matches the rig, a leg sticks to the ground once its curve is past half way
+	constexpr float ContactThreshold = 0.5f;
+	constexpr int32 MaxLegs = 8;
+}
+
+USpiderSwarmGaitProcessor::USpiderSwarmGaitProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = true;
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::AllNetModes);
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+	bRequiresGameThreadExecution = false;
+}
+
+void USpiderSwarmGaitProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FSpiderSwarmMotionFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FSpiderSwarmGaitFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FSpiderSwarmFootContactFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FSpiderSwarmSpineFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FSpiderSwarmGroundFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddConstSharedRequirement<FSpiderSwarmConfigFragment>();
+	EntityQuery.AddTagRequirement<FSpiderSwarmPromotedTag>(EMassFragmentPresence::None);
+}
+
+void USpiderSwarmGaitProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(SwarmGait);
+
+	EntityQuery.ParallelForEachEntityChunk(EntityManager, Context, [](FMassExecutionContext& ChunkContext)
+	{
+		using namespace SpiderSwarmGait;
+
+		const USpiderSwarmConfig* Config = ChunkContext.GetConstSharedFragment<FSpiderSwarmConfigFragment>().Config;
+		if (!Config) return;
+		const FSpiderGaitTable& StickGroundTable = Config->GetToeStickGroundTable();
+		const FSpiderGaitTable& OffsetTable = Config->GetToeOffsetTable();
+		if (!StickGroundTable.IsBaked() || !OffsetTable.IsBaked()) return;
+
+		const TArrayView<FTransformFragment> Transforms = ChunkContext.GetMutableFragmentView<FTransformFragment>();
+		const TConstArrayView<FSpiderSwarmMotionFragment> Motions = ChunkContext.GetFragmentView<
+			FSpiderSwarmMotionFragment>();
+		const TArrayView<FSpiderSwarmGaitFragment> Gaits = ChunkContext.GetMutableFragmentView<
+			FSpiderSwarmGaitFragment>();
+		const TArrayView<FSpiderSwarmFootContactFragment> Contacts = ChunkContext.GetMutableFragmentView<
+			FSpiderSwarmFootContactFragment>();
+		const TArrayView<FSpiderSwarmSpineFragment> Spines = ChunkContext.GetMutableFragmentView<
+			FSpiderSwarmSpineFragment>();
+		const TConstArrayView<FSpiderSwarmGroundFragment> Grounds = ChunkContext.GetFragmentView<
+			FSpiderSwarmGroundFragment>();
+
+		const float DeltaTime = ChunkContext.GetDeltaTimeSeconds();
+		const int32 LegCount = FMath::Clamp(Config->LegCount, 1, MaxLegs);
+		const float MaxWalkSpeed = FMath::Max(Config->MaxWalkSpeed, 1.0f);
+		const float TransitionDuration = FMath::Max(Config->MovementTransitionDuration, UE_KINDA_SMALL_NUMBER);
+		const float SpringOmega = UE_TWO_PI * Config->SpineSpringFrequency;
+
+		float Phases[MaxLegs];
+		float StickFactors[MaxLegs];
+		float OffsetFactors[MaxLegs];
+
+		for (int32 i = 0; i < ChunkContext.GetNumEntities(); i++)
+		{
+			FTransform& Transform = Transforms[i].GetMutableTransform();
+			const FVector& Velocity = Motions[i].Velocity;
+			FSpiderSwarmGaitFragment& Gait = Gaits[i];
+			FSpiderSwarmSpineFragment& Spine = Spines[i];
+
+			// Walk along the velocity, facing where the spider goes
+			Transform.AddToTranslation(Velocity * DeltaTime);
+			const float Speed2D = Velocity.Size2D();
+			if (Speed2D > 1.0f)
+				Transform.SetRotation(FRotator(0, Velocity.Rotation().Yaw, 0).Quaternion());
+
+			// Settle on the ground the subsystem traced, spiders off any ground keep their height
+			if (Grounds[i].bHasGround)
+			{
+				FVector Location = Transform.GetLocation();
+				Location.Z = FMath::FInterpTo(Location.Z, Grounds[i].GroundZ, DeltaTime, Config->GroundFollowSpeed);
+				Transform.SetLocation(Location);
+			}
+
+			// Motor and lagged speed, as the rig gathers them
+			const float HorizontalSpeed = FMath::Clamp(Speed2D / MaxWalkSpeed, 0.0f, 1.0f);
+			Gait.TimeSinceMovement = HorizontalSpeed > 0.01f ? 0.0f : Gait.TimeSinceMovement + DeltaTime;
+			const float OneOnMovement = FMath::Clamp(1.0f - Gait.TimeSinceMovement / TransitionDuration, 0.0f, 1.0f);
+			const float OneOnStall = 1.0f - OneOnMovement;
+
+			// Only the phase matters, keep the motor small so it doesn't lose precision
+			Gait.MotorValue = FMath::Frac(Gait.MotorValue + HorizontalSpeed * DeltaTime * Config->ThrottleMultiplier);
+			Gait.LaggedHorizontalSpeed = FMath::FInterpTo(Gait.LaggedHorizontalSpeed, HorizontalSpeed, DeltaTime,
+			                                              Config->LazyLag + OneOnStall * Config->LazyStallLagMultiplier);
+
+			const float OffCycleMultiplier = Gait.LaggedHorizontalSpeed * Config->AnimationOffCycleCoefficient;
+			for (int32 Leg = 0; Leg < LegCount; Leg++)
+				Phases[Leg] = FMath::Frac(Gait.MotorValue + (1 - OffCycleMultiplier) * Leg / static_cast<float>(LegCount));
+			StickGroundTable.SampleBatch(Phases, StickFactors, LegCount);
+			OffsetTable.SampleBatch(Phases, OffsetFactors, LegCount);
+
+			// Planted legs, and the highest raised leg which lifts the spine like the rig's spine does
+			uint8 LegContacts = 0;
+			float HighestLift = 0.0f;
+			for (int32 Leg = 0; Leg < LegCount; Leg++)
+			{
+				if (StickFactors[Leg] >= ContactThreshold)
+					LegContacts |= 1 << Leg;
+				const float Lift = FMath::Clamp(OffsetFactors[Leg] * (1.0f - StickFactors[Leg]), -2.0f, 2.0f);
+				HighestLift = FMath::Max(HighestLift, Lift);
+			}
+			Contacts[i].Contacts = LegContacts;
+
+			// Damped spring towards the lift, semi-implicit so it stays stable at low frame rates
+			const float SpineTarget = HighestLift * Config->StepHeight * OneOnMovement *
+				(1.0f - Gait.LaggedHorizontalSpeed);
+			const float Acceleration = SpringOmega * SpringOmega * (SpineTarget - Spine.Offset) -
+				2.0f * Config->SpineSpringDampingRatio * SpringOmega * Spine.Velocity;
+			Spine.Velocity += Acceleration * DeltaTime;
+			Spine.Offset += Spine.Velocity * DeltaTime;
+		}
+	});
+}
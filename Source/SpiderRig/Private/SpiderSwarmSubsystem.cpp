@@ -0,0 +1,423 @@
+#include "SpiderSwarmSubsystem.h"
+
+#include "SpiderCharacter.h"
+#include "SpiderRigStats.h"
+#include "SpiderSwarmConfig.h"
+#include "SpiderSwarmFragments.h"
+#include "MassCommonFragments.h"
+#include "MassEntitySubsystem.h"
+#include "MassExecutionContext.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarSpiderSwarmPromotion(
+	TEXT("spiderrig.Swarm.Promotion"),
+	1,
+	TEXT("Swap swarm spiders close to a player with full spider characters, 0 keeps every spider an entity."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarSpiderSwarmMaxPromotionsPerFrame(
+	TEXT("spiderrig.Swarm.MaxPromotionsPerFrame"),
+	2,
+	TEXT("Most swarm spiders turned into characters in a single frame, spawning characters isn't cheap."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarSpiderSwarmGroundTraceInterval(
+	TEXT("spiderrig.Swarm.GroundTraceInterval"),
+	8,
+	TEXT("Frames between two ground traces of a swarm spider, the traces of a swarm are spread over them."),
+	ECVF_Scalability);
+
+namespace SpiderSwarm
+{
+	// Hidden instances are scaled to nothing, instance indices stay stable that way
+	const FTransform HiddenTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+
+	struct FPromotionCandidate
+	{
+		FMassEntityHandle Entity;
+		float DistanceSquared{0};
+	};
+}
+
+void USpiderSwarmSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Collection.InitializeDependency<UMassEntitySubsystem>();
+	Super::Initialize(Collection);
+
+	UpdateQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	UpdateQuery.AddRequirement<FSpiderSwarmSpineFragment>(EMassFragmentAccess::ReadOnly);
+	UpdateQuery.AddRequirement<FSpiderSwarmInstanceFragment>(EMassFragmentAccess::ReadOnly);
+	UpdateQuery.AddRequirement<FSpiderSwarmGroundFragment>(EMassFragmentAccess::ReadWrite);
+	UpdateQuery.AddConstSharedRequirement<FSpiderSwarmConfigFragment>();
+	UpdateQuery.AddTagRequirement<FSpiderSwarmPromotedTag>(EMassFragmentPresence::None);
+}
+
+void USpiderSwarmSubsystem::Deinitialize()
+{
+	Configs.Empty();
+	Instances.Empty();
+	InstanceTransforms.Empty();
+	PromotedCounts.Empty();
+	Promotions.Empty();
+	Super::Deinitialize();
+}
+
+int32 USpiderSwarmSubsystem::FindOrAddSwarm(USpiderSwarmConfig* Config)
+{
+	const int32 Existing = Configs.IndexOfByKey(Config);
+	if (Existing != INDEX_NONE) return Existing;
+
+	// Every swarm is drawn by a single instanced mesh, nothing collides with it
+	AActor* Host = GetWorld()->SpawnActor<AActor>();
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(Host, NAME_None, RF_Transient);
+	Component->SetMobility(EComponentMobility::Movable);
+	Component->SetStaticMesh(Config->Mesh);
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetCanEverAffectNavigation(false);
+	Host->SetRootComponent(Component);
+	Host->AddInstanceComponent(Component);
+	Component->RegisterComponent();
+
+	Configs.Add(Config);
+	Instances.Add(Component);
+	InstanceTransforms.AddDefaulted();
+	PromotedCounts.Add(0);
+	return Configs.Num() - 1;
+}
+
+void USpiderSwarmSubsystem::SpawnSwarm(USpiderSwarmConfig* Config, const TArray<FTransform>& Transforms,
+                                       TArray<FMassEntityHandle>* OutEntities)
+{
+	LLM_SCOPE_BYTAG(SpiderRig);
+	if (!Config || Transforms.IsEmpty()) return;
+
+	// Entities don't replicate, a client swarm would walk on its own and double the server's characters
+	if (GetWorld()->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("USpiderSwarmSubsystem::SpawnSwarm -> Swarms only run on the server or standalone"));
+		return;
+	}
+
+	UMassEntitySubsystem* EntitySubsystem = GetWorld()->GetSubsystem<UMassEntitySubsystem>();
+	if (!EntitySubsystem) return;
+	FMassEntityManager& EntityManager = EntitySubsystem->GetMutableEntityManager();
+
+	// The processor reads the tables from the worker threads, they are baked before it ever sees the swarm
+	Config->BakeGaitTables();
+	const int32 SwarmIndex = FindOrAddSwarm(Config);
+
+	if (!Archetype.IsValid())
+	{
+		Archetype = EntityManager.CreateArchetype({
+			FTransformFragment::StaticStruct(),
+			FSpiderSwarmMotionFragment::StaticStruct(),
+			FSpiderSwarmGaitFragment::StaticStruct(),
+			FSpiderSwarmFootContactFragment::StaticStruct(),
+			FSpiderSwarmSpineFragment::StaticStruct(),
+			FSpiderSwarmGroundFragment::StaticStruct(),
+			FSpiderSwarmInstanceFragment::StaticStruct(),
+		});
+	}
+
+	FSpiderSwarmConfigFragment ConfigFragment;
+	ConfigFragment.Config = Config;
+	FMassArchetypeSharedFragmentValues SharedValues;
+	SharedValues.AddConstSharedFragment(EntityManager.GetOrCreateConstSharedFragment(ConfigFragment));
+	SharedValues.Sort();
+
+	TArray<FMassEntityHandle> Entities;
+	{
+		const TSharedRef<FMassEntityManager::FEntityCreationContext> CreationContext =
+			EntityManager.BatchCreateEntities(Archetype, SharedValues, Transforms.Num(), Entities);
+
+		TArray<FTransform>& SwarmTransforms = InstanceTransforms[SwarmIndex];
+		const int32 FirstInstance = SwarmTransforms.Num();
+		SwarmTransforms.Append(Transforms);
+		Instances[SwarmIndex]->AddInstances(Transforms, false, true);
+
+		for (int32 i = 0; i < Entities.Num(); i++)
+		{
+			EntityManager.GetFragmentDataChecked<FTransformFragment>(Entities[i]).SetTransform(Transforms[i]);
+			EntityManager.GetFragmentDataChecked<FSpiderSwarmInstanceFragment>(Entities[i]).InstanceIndex =
+				FirstInstance + i;
+
+			// Spiders are spawned on their feet, they stand on the ground until the first trace says otherwise
+			FSpiderSwarmGroundFragment& Ground = EntityManager.GetFragmentDataChecked<FSpiderSwarmGroundFragment>(
+				Entities[i]);
+			Ground.GroundZ = Transforms[i].GetLocation().Z;
+			Ground.bHasGround = true;
+
+			// Spread the spiders over the gait cycle, so the swarm doesn't walk in step
+			EntityManager.GetFragmentDataChecked<FSpiderSwarmGaitFragment>(Entities[i]).MotorValue = FMath::FRand();
+		}
+	}
+
+	if (OutEntities)
+		OutEntities->Append(Entities);
+}
+
+void USpiderSwarmSubsystem::SetVelocity(const FMassEntityHandle& Entity, const FVector& Velocity)
+{
+	UMassEntitySubsystem* EntitySubsystem = GetWorld()->GetSubsystem<UMassEntitySubsystem>();
+	if (!EntitySubsystem) return;
+	FMassEntityManager& EntityManager = EntitySubsystem->GetMutableEntityManager();
+	if (!EntityManager.IsEntityValid(Entity)) return;
+	EntityManager.GetFragmentDataChecked<FSpiderSwarmMotionFragment>(Entity).Velocity = Velocity;
+}
+
+void USpiderSwarmSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	if (Configs.IsEmpty()) return;
+	SPIDERRIG_SCOPE_CYCLE_COUNTER(SwarmUpdate);
+	LLM_SCOPE_BYTAG(SpiderRig);
+
+	UMassEntitySubsystem* EntitySubsystem = GetWorld()->GetSubsystem<UMassEntitySubsystem>();
+	if (!EntitySubsystem) return;
+	FMassEntityManager& EntityManager = EntitySubsystem->GetMutableEntityManager();
+
+	TArray<FVector, TInlineAllocator<4>> Views;
+	GatherViews(Views);
+
+	DemoteCharacters(EntityManager, Views);
+	SteerCharacters(EntityManager);
+	UpdateEntities(EntityManager, Views, DeltaTime);
+
+	// Every instance of a swarm in one go
+	for (int32 SwarmIndex = 0; SwarmIndex < Configs.Num(); SwarmIndex++)
+	{
+		if (Instances[SwarmIndex] && !InstanceTransforms[SwarmIndex].IsEmpty())
+			Instances[SwarmIndex]->BatchUpdateInstancesTransforms(0, InstanceTransforms[SwarmIndex], true, true);
+	}
+}
+
+void USpiderSwarmSubsystem::GatherViews(TArray<FVector, TInlineAllocator<4>>& OutViews) const
+{
+	// Remote players never see the swarm, no point in promoting spiders next to them
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController && PlayerController->IsLocalController() && PlayerController->PlayerCameraManager)
+			OutViews.Add(PlayerController->PlayerCameraManager->GetCameraLocation());
+	}
+}
+
+void USpiderSwarmSubsystem::UpdateEntities(FMassEntityManager& EntityManager,
+                                           const TArray<FVector, TInlineAllocator<4>>& Views, const float& DeltaTime)
+{
+	using namespace SpiderSwarm;
+
+	UWorld* World = GetWorld();
+	const bool bCanPromote = CVarSpiderSwarmPromotion.GetValueOnGameThread() != 0 && !Views.IsEmpty();
+	TArray<FPromotionCandidate> Candidates;
+
+	const uint32 GroundTraceInterval = FMath::Max(CVarSpiderSwarmGroundTraceInterval.GetValueOnGameThread(), 1);
+	const uint32 TraceFrame = GroundTraceFrame++;
+	const FCollisionQueryParams GroundQueryParams(SCENE_QUERY_STAT(SpiderSwarmGround), false);
+
+	FMassExecutionContext Context(EntityManager, DeltaTime);
+	UpdateQuery.ForEachEntityChunk(EntityManager, Context, [&](FMassExecutionContext& ChunkContext)
+	{
+		const USpiderSwarmConfig* Config = ChunkContext.GetConstSharedFragment<FSpiderSwarmConfigFragment>().Config;
+		const int32 SwarmIndex = Configs.IndexOfByKey(Config);
+		if (SwarmIndex == INDEX_NONE) return;
+
+		const TConstArrayView<FTransformFragment> Transforms = ChunkContext.GetFragmentView<FTransformFragment>();
+		const TConstArrayView<FSpiderSwarmSpineFragment> Spines = ChunkContext.GetFragmentView<
+			FSpiderSwarmSpineFragment>();
+		const TConstArrayView<FSpiderSwarmInstanceFragment> InstanceFragments = ChunkContext.GetFragmentView<
+			FSpiderSwarmInstanceFragment>();
+		const TArrayView<FSpiderSwarmGroundFragment> Grounds = ChunkContext.GetMutableFragmentView<
+			FSpiderSwarmGroundFragment>();
+		TArray<FTransform>& SwarmTransforms = InstanceTransforms[SwarmIndex];
+
+		const bool bCanPromoteSwarm = bCanPromote && Config->SpiderClass && Config->MaxPromoted > 0;
+		const float PromoteDistanceSquared = FMath::Square(Config->PromoteDistance);
+
+		for (int32 i = 0; i < ChunkContext.GetNumEntities(); i++)
+		{
+			const FTransform& Transform = Transforms[i].GetTransform();
+			FTransform& InstanceTransform = SwarmTransforms[InstanceFragments[i].InstanceIndex];
+			InstanceTransform = Transform;
+			InstanceTransform.AddToTranslation(Transform.GetRotation().GetUpVector() * Spines[i].Offset);
+
+			// Async results only live for a frame, the processor follows whatever ground was found last
+			FSpiderSwarmGroundFragment& Ground = Grounds[i];
+			if (Ground.TraceHandle.IsValid())
+			{
+				FTraceDatum TraceDatum;
+				if (World->QueryTraceData(Ground.TraceHandle, TraceDatum))
+				{
+					const FHitResult* HitResult = FHitResult::GetFirstBlockingHit(TraceDatum.OutHits);
+					Ground.bHasGround = HitResult != nullptr;
+					if (HitResult)
+						Ground.GroundZ = HitResult->ImpactPoint.Z;
+				}
+				Ground.TraceHandle = FTraceHandle();
+			}
+			if ((InstanceFragments[i].InstanceIndex + TraceFrame) % GroundTraceInterval == 0)
+			{
+				const FVector Location = Transform.GetLocation();
+				Ground.TraceHandle = World->AsyncLineTraceByChannel(
+					EAsyncTraceType::Single, Location + FVector::UpVector * Config->GroundTraceHeight,
+					Location - FVector::UpVector * Config->GroundTraceDepth, ECC_Visibility, GroundQueryParams);
+			}
+
+			if (!bCanPromoteSwarm) continue;
+			float ClosestDistanceSquared = TNumericLimits<float>::Max();
+			for (const FVector& View : Views)
+				ClosestDistanceSquared = FMath::Min(ClosestDistanceSquared,
+				                                    FVector::DistSquared(View, Transform.GetLocation()));
+			if (ClosestDistanceSquared < PromoteDistanceSquared)
+				Candidates.Add({ChunkContext.GetEntity(i), ClosestDistanceSquared});
+		}
+	});
+
+	if (Candidates.IsEmpty()) return;
+
+	// Closest first, entity composition only changes once the chunks are done with
+	Candidates.Sort([](const FPromotionCandidate& A, const FPromotionCandidate& B)
+	{
+		return A.DistanceSquared < B.DistanceSquared;
+	});
+	int32 Budget = CVarSpiderSwarmMaxPromotionsPerFrame.GetValueOnGameThread();
+	for (const FPromotionCandidate& Candidate : Candidates)
+	{
+		if (Budget <= 0) break;
+		if (Promote(EntityManager, Candidate.Entity))
+			Budget--;
+	}
+}
+
+float USpiderSwarmSubsystem::GetCapsuleHalfHeight(const int32& SwarmIndex) const
+{
+	const ASpiderCharacter* DefaultCharacter = Configs[SwarmIndex]->SpiderClass
+		                                           ? Configs[SwarmIndex]->SpiderClass->GetDefaultObject<ASpiderCharacter>()
+		                                           : nullptr;
+	return DefaultCharacter ? DefaultCharacter->GetCapsuleComponent()->GetScaledCapsuleHalfHeight() : 0.0f;
+}
+
+bool USpiderSwarmSubsystem::Promote(FMassEntityManager& EntityManager, const FMassEntityHandle& Entity)
+{
+	const USpiderSwarmConfig* Config = EntityManager.GetConstSharedFragmentDataChecked<FSpiderSwarmConfigFragment>(
+		Entity).Config;
+	const int32 SwarmIndex = Configs.IndexOfByKey(Config);
+	if (SwarmIndex == INDEX_NONE || PromotedCounts[SwarmIndex] >= Config->MaxPromoted) return false;
+
+	// Entities stand on their feet, characters are placed by the center of their capsule
+	const FTransform& Transform = EntityManager.GetFragmentDataChecked<FTransformFragment>(Entity).GetTransform();
+	const FVector Location = Transform.GetLocation() + FVector::UpVector * GetCapsuleHalfHeight(SwarmIndex);
+
+	const FTransform SpawnTransform(Transform.Rotator(), Location);
+	ASpiderCharacter* Character = GetWorld()->SpawnActorDeferred<ASpiderCharacter>(
+		Config->SpiderClass, SpawnTransform, nullptr, nullptr,
+		ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding);
+	if (!Character) return false;
+
+	// The rest of the swarm isn't on the clients either, a lone replicated spider would pop out of nowhere
+	Character->SetReplicates(false);
+	Character->FinishSpawning(SpawnTransform);
+	if (!IsValid(Character)) return false;
+
+	if (!Character->GetController())
+		Character->SpawnDefaultController();
+	Character->GetCharacterMovement()->Velocity = EntityManager.GetFragmentDataChecked<FSpiderSwarmMotionFragment>(
+		Entity).Velocity;
+
+	const int32 InstanceIndex = EntityManager.GetFragmentDataChecked<FSpiderSwarmInstanceFragment>(Entity).InstanceIndex;
+	InstanceTransforms[SwarmIndex][InstanceIndex] = SpiderSwarm::HiddenTransform;
+
+	EntityManager.AddTagToEntity(Entity, FSpiderSwarmPromotedTag::StaticStruct());
+	Promotions.Add(Entity, {Character, SwarmIndex, InstanceIndex});
+	PromotedCounts[SwarmIndex]++;
+	SPIDERRIG_INC_COUNTER_BY(SwarmPromotions, 1);
+	return true;
+}
+
+void USpiderSwarmSubsystem::DemoteCharacters(FMassEntityManager& EntityManager,
+                                             const TArray<FVector, TInlineAllocator<4>>& Views)
+{
+	const bool bCanPromote = CVarSpiderSwarmPromotion.GetValueOnGameThread() != 0;
+	for (auto It = Promotions.CreateIterator(); It; ++It)
+	{
+		const FMassEntityHandle Entity = It.Key();
+		const FSpiderSwarmPromotion& Promotion = It.Value();
+		ASpiderCharacter* Character = Promotion.Character.Get();
+
+		// Characters killed or removed by the game take their entity with them, the instance stays hidden
+		if (!IsValid(Character) || !EntityManager.IsEntityValid(Entity))
+		{
+			if (IsValid(Character))
+				Character->Destroy();
+			if (EntityManager.IsEntityValid(Entity))
+				EntityManager.DestroyEntity(Entity);
+			PromotedCounts[Promotion.SwarmIndex]--;
+			It.RemoveCurrent();
+			continue;
+		}
+
+		// Spiders a player took over stay characters
+		if (Character->IsPlayerControlled()) continue;
+
+		const float DemoteDistanceSquared = FMath::Square(Configs[Promotion.SwarmIndex]->DemoteDistance);
+		const FVector Location = Character->GetActorLocation();
+		const bool bIsClose = bCanPromote && Views.ContainsByPredicate([&](const FVector& View)
+		{
+			return FVector::DistSquared(View, Location) <= DemoteDistanceSquared;
+		});
+		if (bIsClose) continue;
+
+		// Hand the character's movement back to the entity, the instance shows up where the character was
+		FTransform Transform(FRotator(0, Character->GetActorRotation().Yaw, 0),
+		                     Location - FVector::UpVector * GetCapsuleHalfHeight(Promotion.SwarmIndex));
+		EntityManager.GetFragmentDataChecked<FTransformFragment>(Entity).SetTransform(Transform);
+		EntityManager.GetFragmentDataChecked<FSpiderSwarmMotionFragment>(Entity).Velocity =
+			Character->GetCharacterMovement()->Velocity;
+		FSpiderSwarmGroundFragment& Ground = EntityManager.GetFragmentDataChecked<FSpiderSwarmGroundFragment>(Entity);
+		Ground.TraceHandle = FTraceHandle();
+		Ground.GroundZ = Transform.GetLocation().Z;
+		Ground.bHasGround = Character->GetCharacterMovement()->IsMovingOnGround();
+		InstanceTransforms[Promotion.SwarmIndex][Promotion.InstanceIndex] = Transform;
+
+		if (AController* Controller = Character->GetController())
+			Controller->Destroy();
+		Character->Destroy();
+
+		EntityManager.RemoveTagFromEntity(Entity, FSpiderSwarmPromotedTag::StaticStruct());
+		PromotedCounts[Promotion.SwarmIndex]--;
+		It.RemoveCurrent();
+		SPIDERRIG_INC_COUNTER_BY(SwarmDemotions, 1);
+	}
+}
+
+void USpiderSwarmSubsystem::SteerCharacters(FMassEntityManager& EntityManager)
+{
+	// The velocity set on the entity is still what the swarm wants, the character walks along it as input
+	for (const TPair<FMassEntityHandle, FSpiderSwarmPromotion>& Pair : Promotions)
+	{
+		ASpiderCharacter* Character = Pair.Value.Character.Get();
+		if (!IsValid(Character) || Character->IsPlayerControlled() || !EntityManager.IsEntityValid(Pair.Key)) continue;
+
+		const FVector& Velocity = EntityManager.GetFragmentDataChecked<FSpiderSwarmMotionFragment>(Pair.Key).Velocity;
+		const float MaxWalkSpeed = FMath::Max(Character->GetCharacterMovement()->MaxWalkSpeed, 1.0f);
+		const float Speed2D = Velocity.Size2D();
+		if (Speed2D > UE_KINDA_SMALL_NUMBER)
+			Character->AddMovementInput(Velocity.GetSafeNormal2D(), FMath::Min(Speed2D / MaxWalkSpeed, 1.0f), true);
+	}
+}
+
+TStatId USpiderSwarmSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USpiderSwarmSubsystem, STATGROUP_Tickables);
+}
+
+bool USpiderSwarmSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Engine/TriggerVolume.h"
+#include "CameraSplineTable.h"
 #include "CameraConfigVolume.generated.h"
 
 class USplineComponent;
@@ -16,6 +17,28 @@ public:
 	// Sets default values for this actor's properties
 	ACameraConfigVolume();
 
+	virtual void PostInitializeComponents() override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Camera path baked by arc length, re-baked if the volume was moved since
+	const FCameraSplineTable& GetCameraPathTable();
+
 	UPROPERTY(EditAnywhere)
 	TObjectPtr<USplineComponent> CameraPath;
+
+	// Distance between two baked points of the camera path
+	UPROPERTY(EditAnywhere, meta = (ClampMin = 1, Units = "cm"))
+	float CameraPathSampleSpacing = 10.0f;
+
+	// Overlapping volumes of a higher priority are blended over the lower ones
+	UPROPERTY(EditAnywhere)
+	int32 Priority = 0;
+
+	// Distance outside of the volume over which its camera path blends in
+	UPROPERTY(EditAnywhere, meta = (ClampMin = 0, Units = "cm"))
+	float BlendDistance = 100.0f;
+
+private:
+	FCameraSplineTable CameraPathTable;
 };
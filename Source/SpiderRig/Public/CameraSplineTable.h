@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USplineComponent;
+
+// Where the last lookup ended on a table, the next one starts from there
+struct FCameraSplineCursor
+{
+	int32 SampleIndex{INDEX_NONE};
+	FVector LocationWorld{0};
+};
+
+// A spline baked into world space points evenly spaced by arc length. Closest point lookups start from the
+// sample found on the previous lookup and only walk as far as the closest point moved, a query which jumped
+// further than a few samples searches every sample again.
+class SPIDERRIG_API FCameraSplineTable
+{
+public:
+	void Bake(const USplineComponent* Spline, const float& InSampleSpacing);
+
+	// Whether the table still matches the spline and spacing, moving the spline's owner makes it stale
+	bool IsBakedFrom(const USplineComponent* Spline, const float& InSampleSpacing) const;
+
+	// Closest point on the baked spline, InOutCursor holds the previous lookup to start from, INDEX_NONE searches
+	// every sample, and receives this lookup for the next one
+	FVector FindLocationClosestTo(const FVector& LocationWorld, FCameraSplineCursor& InOutCursor) const;
+
+	FORCEINLINE bool IsBaked() const
+	{
+		return Points.Num() >= 2;
+	}
+
+private:
+	int32 FindClosestSample(const FVector& LocationWorld) const;
+	int32 WalkToClosestSample(const FVector& LocationWorld, int32 SampleIndex) const;
+	int32 WrapIndex(const int32& Index) const;
+
+	// for closed loops the last point is the first one again, so every segment is [i, i + 1]
+	TArray<FVector> Points;
+	bool bIsClosedLoop{false};
+
+	FTransform BakedTransform;
+	float SampleSpacing{0};
+	const USplineComponent* BakedSpline{nullptr};
+};
@@ -0,0 +1,38 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FSpiderLODDef.generated.h"
+
+USTRUCT(BlueprintType)
+struct SPIDERRIG_API FSpiderLODDef
+{
+	GENERATED_BODY()
+
+	FSpiderLODDef() = default;
+
+	FSpiderLODDef(const int32 InIKSolveIteration, const float InIKPrecision, const int32 InTraceInterval,
+	              const int32 InLegUpdateInterval, const bool bInFreezeLegs)
+		: IKSolveIteration(InIKSolveIteration), IKPrecision(InIKPrecision), TraceInterval(InTraceInterval),
+		  LegUpdateInterval(InLegUpdateInterval), bFreezeLegs(bInFreezeLegs)
+	{
+	}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "IK Iteration", ClampMin = 1))
+	int32 IKSolveIteration = 15;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "IK Precision", ClampMin = 0))
+	float IKPrecision = 0.1f;
+
+	// Every leg sweeps once in this many evaluations, legs are staggered over the frames
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Trace Interval", ClampMin = 1))
+	int32 TraceInterval = 1;
+
+	// Every leg is solved once in this many evaluations, round-robin over the legs
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Leg Update Interval", ClampMin = 1))
+	int32 LegUpdateInterval = 1;
+
+	// Keep the legs in their last pose and only drive the spine
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Freeze Legs"))
+	bool bFreezeLegs = false;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "SpiderBenchmarkCommandlet.generated.h"
+
+class ASpiderCharacter;
+class UStaticMesh;
+class FJsonObject;
+
+// Counters of a single benchmark frame
+struct FSpiderBenchmarkFrame
+{
+	double FrameSeconds{0};
+	double ExecuteSeconds{0};
+	double PreUpdateSeconds{0};
+	int32 ExecuteCount{0};
+	int32 SweepCount{0};
+	int32 IKSolveCount{0};
+	int32 IKIterationCount{0};
+};
+
+// Scripted path of a single spider, walked in a loop
+struct FSpiderBenchmarkPath
+{
+	TArray<FVector> Waypoints;
+	int32 CurrentWaypoint{0};
+};
+
+// Runs a crowd of spiders headless on a seeded procedural terrain and records how long their rigs take.
+//
+// UnrealEditor-Cmd SpiderBot.uproject -run=SpiderBenchmark -nullrhi -unattended
+//     -Count=500 -Seed=1 -Frames=600 -Warmup=60 -DeltaTime=0.0166667
+//     -Character=/Game/SpiderBot/BP_Robot.BP_Robot_C -Output=<path without extension>
+//     -Baseline=<summary json> -Threshold=0.1 -UpdateBaseline
+//
+// Writes every frame to <Output>.csv and a summary to <Output>.json, when a baseline is given the summary
+// is compared against it and the commandlet fails if a timing got slower than the threshold allows.
+UCLASS()
+class SPIDERRIG_API USpiderBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+	void BuildTerrain(UWorld* World, FRandomStream& Stream);
+	void SpawnSpiders(UWorld* World, FRandomStream& Stream, UClass* CharacterClass);
+	void DriveSpiders();
+
+	// Top of a random tile, tiles on the border are left out so the spiders stay on the terrain
+	FVector GetRandomTileLocation(FRandomStream& Stream) const;
+
+	TSharedRef<FJsonObject> MakeSummary() const;
+	bool WriteResults(const FString& OutputPath, const TSharedRef<FJsonObject>& Summary) const;
+	bool CompareBaseline(const FString& BaselinePath, const TSharedRef<FJsonObject>& Summary) const;
+
+	UPROPERTY()
+	TObjectPtr<UStaticMesh> TileMesh;
+
+	UPROPERTY()
+	TArray<TObjectPtr<ASpiderCharacter>> Spiders;
+
+	// top centre of every terrain tile, [Y * GridSize + X]
+	TArray<FVector> TileLocations;
+	int32 GridSize{0};
+
+	TArray<FSpiderBenchmarkPath> Paths;
+	TArray<FSpiderBenchmarkFrame> Frames;
+
+	// settings parsed from the command line
+	int32 SpiderCount{100};
+	int32 Seed{1};
+	int32 FrameCount{600};
+	int32 WarmupFrameCount{60};
+	float DeltaTime{1.0f / 60.0f};
+	float Threshold{0.1f};
+	FString CharacterPath;
+
+public:
+	USpiderBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -3,15 +3,18 @@
 #pragma once
 
 #include "Camera/PlayerCameraManager.h"
+#include "WorldCollision.h"
+#include "CameraSplineTable.h"
+#include "SpiderCameraZoneSubsystem.h"
 #include "SpiderCamera.generated.h"
 
-class ACameraConfigVolume;
 class ASpiderCharacter;
 
+// Where the camera was on a locked volume's path, the next lookup starts from there
 struct FCameraSplineMemory
 {
-	int32 Id;
-	FVector PrevPosition;
+	uint32 Id{0};
+	FCameraSplineCursor Cursor;
 };
 
 UCLASS()
@@ -19,22 +22,23 @@ class SPIDERRIG_API ASpiderCamera : public APlayerCameraManager
 {
 	GENERATED_BODY()
 
-	UFUNCTION()
-	void OnBeginOverlap(AActor* OverlappedActor, AActor* OtherActor);
-	
-	UFUNCTION()
-	void OnEndOverlap(AActor* OverlappedActor, AActor* OtherActor);
+	void UpdateZones(ASpiderCharacter* Character);
+	FVector CalculateRailLocation(const FVector& LocationWorld);
 
 	void CalculateLagSpeeds(FVector& LagSpeeds, float& RotSpeed) const;
 	void CalculateFreeLook(const bool& bIsGrounded);
-	void TraceCameraCollision(const ASpiderCharacter* Character, const FVector& TraceOrigin, FVector& Target, const float& TraceRadius = 5.0f) const;
+	void TraceCameraCollision(const ASpiderCharacter* Character, const FVector& TraceOrigin, FVector& Target,
+	                          const float& DeltaTime, const float& TraceRadius = 5.0f);
+	void UpdateCollisionPullIn(const float& DesiredPullIn, const float& DeltaTime);
 
 	bool bIsLocked = false;
 	
 	APawn* PreviouslyPossessedPawn{nullptr};
-	ACameraConfigVolume* CurrentLockedVolume{nullptr};
-	
-	int32 OverlapCounter{0};
+	bool bIsInZone = false;
+
+	// Camera volumes around the view target this frame, and where the camera was on each of their paths
+	TArray<FSpiderCameraZone> Zones;
+	TArray<FCameraSplineMemory> SplineMemories;
 	
 	FRotator FreeLookRotation{0};
 	FRotator TargetFreeLookRotation{0};
@@ -48,6 +52,12 @@ class SPIDERRIG_API ASpiderCamera : public APlayerCameraManager
 
 	FVector LazyDirection{0};
 
+	// Camera collision, the sweep of a frame is collected on the next one
+	FCollisionQueryParams CollisionQueryParams;
+	TWeakObjectPtr<const ASpiderCharacter> CollisionCharacter;
+	FTraceHandle CollisionHandle;
+	float CollisionPullIn{0};
+
 protected:
 	virtual void UpdateViewTargetInternal(FTViewTarget& OutVT, float DeltaTime) override;
 	
@@ -63,4 +73,21 @@ public:
 	
 	UPROPERTY(EditAnywhere)
 	float LookLagSpeed{10.0f};
+
+	// Sweep the camera collision asynchronously and use it on the next frame, instead of a blocking sweep
+	UPROPERTY(EditAnywhere, Category = "Collision")
+	bool bUseAsyncCollision{true};
+
+	// How fast the camera is pulled in front of an obstacle
+	UPROPERTY(EditAnywhere, Category = "Collision")
+	float CollisionPullInSpeed{30.0f};
+
+	// How fast the camera moves back out once the obstacle is gone
+	UPROPERTY(EditAnywhere, Category = "Collision")
+	float CollisionReleaseSpeed{4.0f};
+
+	// The camera only moves back out once it is pulled in this much further than needed or once nothing blocks
+	// it anymore, so it doesn't jitter
+	UPROPERTY(EditAnywhere, Category = "Collision", meta = (ClampMin = 0, Units = "cm"))
+	float CollisionHysteresis{10.0f};
 };
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "SpiderCameraZoneSubsystem.generated.h"
+
+class ACameraConfigVolume;
+
+// Camera volume the view is in or close to, the weights of every zone found at once add up to one
+struct FSpiderCameraZone
+{
+	TWeakObjectPtr<ACameraConfigVolume> Volume;
+	float Weight{0};
+	bool bIsInside{false};
+};
+
+// Camera volumes of the world in a bounding volume hierarchy, queried by the cameras once per frame instead of
+// tracking the overlaps of their pawn. Volumes don't move, the hierarchy is only rebuilt when volumes are
+// added or removed (e.g. by level streaming).
+UCLASS()
+class SPIDERRIG_API USpiderCameraZoneSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FNode
+	{
+		FBox Bounds{ForceInit};
+
+		// leaves hold [First, First + Count) of the sorted volumes, inner nodes their left child at First and
+		// their right child right after it
+		int32 First{0};
+		int32 Count{0};
+	};
+
+	struct FEntry
+	{
+		TWeakObjectPtr<ACameraConfigVolume> Volume;
+		FBox Bounds{ForceInit};
+		int32 Priority{0};
+		float BlendDistance{0};
+	};
+
+	TArray<TWeakObjectPtr<ACameraConfigVolume>> Volumes;
+	TArray<FEntry> Entries;
+	TArray<FNode> Nodes;
+	bool bIsDirty{false};
+
+	void Rebuild();
+	void BuildNode(const int32& NodeIndex, const int32& First, const int32& Count);
+	void CollectEntries(const FVector& LocationWorld, TArray<int32, TInlineAllocator<8>>& OutEntries) const;
+
+public:
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	void RegisterVolume(ACameraConfigVolume* Volume);
+	void UnregisterVolume(ACameraConfigVolume* Volume);
+
+	// Zones around a location, highest priority first. Zones of a higher priority are blended over the lower
+	// ones by how deep the location is in them, zones of the same priority share their weight.
+	void FindZones(const FVector& LocationWorld, TArray<FSpiderCameraZone>& OutZones);
+};
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "GameFramework/Character.h"
+#include "SpiderGaitNetState.h"
 #include "SpiderCharacter.generated.h"
 
 class USpiderEffectsComponent;
@@ -12,13 +13,40 @@ class SPIDERRIG_API ASpiderCharacter: public ACharacter
 	GENERATED_BODY()
 	FRotator ActorMovementDirection{0};
 
+	// Gait of the server's rig, simulated proxies only, the owner and the server evaluate their own
+	UPROPERTY(ReplicatedUsing = OnRep_GaitState)
+	FSpiderGaitNetState GaitState;
+	uint32 GaitStateSerial{0};
+
+	UFUNCTION()
+	void OnRep_GaitState();
+
 protected:
-	ASpiderCharacter();
+	ASpiderCharacter(const FObjectInitializer& ObjectInitializer);
 	
 	bool bOrientRotationToMovement = false;
 	friend class ASpiderCamera;
 
 public:
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// Set by the rig on the server after every evaluation
+	FORCEINLINE void SetGaitState(const FSpiderGaitNetState& NewGaitState)
+	{
+		GaitState = NewGaitState;
+	}
+
+	FORCEINLINE const FSpiderGaitNetState& GetGaitState() const
+	{
+		return GaitState;
+	}
+
+	// Bumped on every received update, tells the rig whether the state is new
+	FORCEINLINE uint32 GetGaitStateSerial() const
+	{
+		return GaitStateSerial;
+	}
+
 	void ApplyCharacterMovement(const FVector2d& Movement);
 	void ApplyCameraMovement(const FVector2d& Movement);
 	void ApplyJump();
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "SpiderCrowdSubsystem.generated.h"
+
+class USpiderRig;
+
+// Timings of the last parallel solve, used to report how the crowd scales over worker threads
+struct FSpiderCrowdStats
+{
+	int32 RigCount{0};
+	int32 WorkerCount{0};
+	double WallSeconds{0};
+	double RigSeconds{0};
+	double AverageWallSeconds{0};
+	double AverageRigSeconds{0};
+};
+
+// Solves every registered spider rig of the world together, spread over the worker threads.
+// Rigs gather their inputs while evaluating, the subsystem solves them all at the end of the frame
+// and each rig commits its own result on its next evaluation. Only the solve is spread, the gather stays
+// in each rig's own evaluation. Scaling over the worker threads is printed by spiderrig.Crowd.Report.
+UCLASS()
+class SPIDERRIG_API USpiderCrowdSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	TArray<TWeakObjectPtr<USpiderRig>> Rigs;
+	TArray<USpiderRig*> PendingRigs;
+	FSpiderCrowdStats Stats;
+
+public:
+	void RegisterRig(USpiderRig* Rig);
+	void UnregisterRig(USpiderRig* Rig);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	FORCEINLINE const FSpiderCrowdStats& GetStats() const
+	{
+		return Stats;
+	}
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "SpiderEffectsComponent.h"
+#include "SpiderEffectBudgetSubsystem.generated.h"
+
+class UNiagaraComponent;
+
+// Landing waiting for the budget, merged with the other landings close by
+struct FSpiderPendingLanding
+{
+	FSpiderLandingRequest Request;
+	TWeakObjectPtr<USpiderEffectsComponent> Effects;
+	float Significance{0};
+};
+
+// Landing effects of every spider of the world under one budget. Landings are queued during the frame and
+// played at its end, nearby landings are merged into a bigger puff, off-screen and insignificant ones are
+// dropped and only the most significant ones are played within the per frame and live effect caps.
+UCLASS()
+class SPIDERRIG_API USpiderEffectBudgetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	TArray<FSpiderPendingLanding> PendingLandings;
+	TArray<FSpiderPendingLanding> MergedLandings;
+	TMap<FIntVector, int32> MergeCells;
+
+	// puffs played by the budget, only the ones still active count against the live cap
+	TArray<TWeakObjectPtr<UNiagaraComponent>> LivePuffs;
+
+	void MergeLandings();
+	void RankLandings();
+	int32 CountLivePuffs();
+
+public:
+	void QueueLandings(USpiderEffectsComponent* Effects, const TArray<FSpiderLandingRequest>& Requests);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+};
@@ -6,17 +6,43 @@
 #include "SpiderEffectsComponent.generated.h"
 
 class UNiagaraSystem;
+class UNiagaraComponent;
+
+// Landing effect requested by an evaluation
+struct FSpiderLandingRequest
+{
+	FVector LocationWorld{0};
+	float JumpImpact{0};
+	bool bIsLeg{false};
+};
 
 UCLASS()
 class SPIDERRIG_API USpiderEffectsComponent : public USceneComponent
 {
 	GENERATED_BODY()
 
+	// puffs are reused round robin, the oldest one gets restarted when they are all busy
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UNiagaraComponent>> PuffPool;
+	int32 NextPuff{0};
+
+	UNiagaraComponent* AcquirePuff();
+
 public:
 	USpiderEffectsComponent();
-	void NotifyFallenAfterJump(const FVector& WorldLocation, const float &JumpImpact, const bool& bIsLeg );
+	virtual void OnUnregister() override;
+
+	// Game thread only, every landing of a single evaluation at once, they go through the world's effect budget
+	void NotifyFallenAfterJump(const TArray<FSpiderLandingRequest>& Requests);
+
+	// Start a puff right away, returns null when there is no effect to play
+	UNiagaraComponent* PlayPuff(const FSpiderLandingRequest& Request);
 
 	UPROPERTY(EditAnywhere)
 	TObjectPtr<UNiagaraSystem> PuffEffect;
 
+	// A landing plays one puff for the spine and one per leg
+	UPROPERTY(EditAnywhere, meta = (ClampMin = 1))
+	int32 PuffPoolSize = 9;
+
 };
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "SpiderFootholdBakeCommandlet.generated.h"
+
+// Bakes the walkable static collision of a level into a foothold map saved next to it.
+//
+// UnrealEditor-Cmd SpiderBot.uproject -run=SpiderFootholdBake -Map=/Game/Maps/Level -unattended
+//     -Spacing=25 -CellSize=200 -MaxSlope=60 -LedgeHeight=30 -MaxLayers=8 -MaxBlocking=16
+//     -Bounds=MinX,MinY,MinZ,MaxX,MaxY,MaxZ -Output=<package name>
+//
+// Without bounds the whole level is sampled. A World Partition cell or any other region is baked by giving
+// its bounds and an output package, such maps are registered with the foothold subsystem by hand.
+UCLASS()
+class SPIDERRIG_API USpiderFootholdBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USpiderFootholdBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "SpiderFootholdMap.generated.h"
+
+// Ground a leg sweep resolved to from the baked footholds
+struct FSpiderFoothold
+{
+	FVector Location{0};
+	FVector Normal{0};
+	bool bIsLedge{false};
+};
+
+// Settings of a foothold bake
+struct FSpiderFootholdBakeSettings
+{
+	// world area which gets sampled, e.g. a single World Partition cell
+	FBox Bounds{ForceInit};
+	float SampleSpacing{25.0f};
+	float CellSize{200.0f};
+	float MaxSlopeDegrees{60.0f};
+	float LedgeHeight{30.0f};
+	int32 MaxLayers{8};
+	// samples kept per column for the inside of solids, walls are only ever seen from inside by a top down bake
+	int32 MaxBlockingSamples{16};
+};
+
+// Walkable surfaces of the static collision of a level, baked offline into flat arrays. Steep surfaces and the
+// inside of solids are baked as blocking samples, a sweep crossing one before its ground is left to the physics scene.
+// Samples are sorted by the cell they fall in, a cell is found by binary searching the sorted cell keys
+// and its samples are the range [CellStarts[Cell], CellStarts[Cell + 1]). Every array is plain old data
+// and is bulk serialized, so loading the asset is a straight copy of the baked memory.
+UCLASS()
+class SPIDERRIG_API USpiderFootholdMap : public UDataAsset
+{
+	GENERATED_BODY()
+
+	TArray<uint64> CellKeys;
+	TArray<int32> CellStarts;
+
+	// per sample, indexed by [CellStarts[Cell] + i]
+	TArray<FVector3f> Positions;
+	TArray<FVector3f> Normals;
+	TArray<uint8> Flags;
+
+	FBox Bounds{ForceInit};
+	float SampleSpacing{0};
+	float CellSize{0};
+
+	uint64 GetCellKey(const FVector& LocationWorld) const;
+	int32 FindCell(const uint64& Key) const;
+
+public:
+	enum EFootholdFlags : uint8
+	{
+		Foothold_Ledge = 1 << 0,
+		Foothold_Blocking = 1 << 1,
+	};
+
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+	// Find the ground along a leg sweep, returns false when the sweep isn't covered by the footholds or
+	// static geometry would block it before it reaches the ground
+	bool FindFoothold(const FVector& TraceOriginWorld, const FVector& TraceEndWorld, FSpiderFoothold& OutFoothold) const;
+
+#if WITH_EDITOR
+	// Sample the static collision of the world from above, replaces whatever was baked before
+	void Bake(UWorld* World, const FSpiderFootholdBakeSettings& Settings);
+#endif
+
+	// Baked maps are found by name next to the level they were baked from
+	static FString GetMapPackageName(const FString& WorldPackageName);
+
+	FORCEINLINE const FBox& GetBounds() const
+	{
+		return Bounds;
+	}
+
+	FORCEINLINE int32 GetSampleCount() const
+	{
+		return Positions.Num();
+	}
+};
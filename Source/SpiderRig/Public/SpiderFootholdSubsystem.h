@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "SpiderFootholdSubsystem.generated.h"
+
+class ULevel;
+class UPrimitiveComponent;
+class USpiderFootholdMap;
+struct FSpiderFoothold;
+
+// Foothold maps of every loaded level, looked up by the leg sweeps before going to the physics scene.
+// A level's map is the asset baked next to it by the SpiderFootholdBake commandlet, maps of World Partition
+// cells or other regions can be registered by hand. Movable collision isn't part of the maps, sweeps close
+// to it are left to the physics scene. Static and stationary collision is baked, only movable is tracked.
+UCLASS()
+class SPIDERRIG_API USpiderFootholdSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<USpiderFootholdMap>> Maps;
+
+	// level each map was loaded for, null for maps registered by hand
+	TArray<TWeakObjectPtr<ULevel>> MapLevels;
+
+	// levels whose actors were already looked through for movable collision
+	TArray<TWeakObjectPtr<ULevel>> ScannedLevels;
+
+	// movable collision, and its bounds as of the last tick in a coarse grid of [Cell] -> MovableBounds index
+	TSet<TWeakObjectPtr<UPrimitiveComponent>> MovableComponents;
+	TArray<FBox> MovableBounds;
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> MovableGrid;
+	FDelegateHandle ActorSpawnedHandle;
+
+	void OnLevelAdded(ULevel* Level, UWorld* World);
+	void OnLevelRemoved(ULevel* Level, UWorld* World);
+	void OnActorSpawned(AActor* Actor);
+	void AddMovableComponents(const AActor* Actor);
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	void RegisterMap(USpiderFootholdMap* Map);
+	void UnregisterMap(USpiderFootholdMap* Map);
+
+	// Find the ground along a leg sweep, returns false when the sweep has to be issued
+	bool FindFoothold(const FVector& TraceOriginWorld, const FVector& TraceEndWorld, const float& TraceRadius,
+	                  FSpiderFoothold& OutFoothold) const;
+
+	FORCEINLINE bool HasMaps() const
+	{
+		return !Maps.IsEmpty();
+	}
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiderGaitNetState.generated.h"
+
+// Gait of a spider as the server evaluated it, a handful of bytes per update. Clients don't receive any bone,
+// their rig rebuilds the legs locally and converges its gait to this state between updates.
+USTRUCT()
+struct SPIDERRIG_API FSpiderGaitNetState
+{
+	GENERATED_BODY()
+
+	// fractional part of the motor value, only the phase within the gait cycle matters
+	uint16 MotorPhase{0};
+
+	// lagged horizontal speed over [0, 1]
+	uint8 HorizontalSpeed{0};
+
+	// impact of the last landing in 2 units steps
+	uint8 LandingImpact{0};
+
+	// landings so far, wraps around, so clients notice landings in between two updates
+	uint8 LandingCount{0};
+
+	bool bIsFalling{false};
+
+	// whether the first eight legs stick to the ground, only sent when enabled on the rig
+	bool bHasContactHints{false};
+	uint8 LegContacts{0};
+
+	static constexpr uint8 LandingCountMask = 0x7;
+	static constexpr int32 MaxContactHints = 8;
+
+	static FSpiderGaitNetState Quantize(const float& MotorValue, const float& LaggedHorizontalSpeed,
+	                                    const float& JumpImpact, const uint8& InLandingCount, const bool& bInIsFalling);
+
+	float GetMotorPhase() const;
+	float GetHorizontalSpeed() const;
+	float GetLandingImpact() const;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FSpiderGaitNetState& Other) const;
+};
+
+template <>
+struct TStructOpsTypeTraits<FSpiderGaitNetState> : TStructOpsTypeTraitsBase2<FSpiderGaitNetState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
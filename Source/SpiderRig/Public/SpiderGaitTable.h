@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UCurveFloat;
+
+// A curve baked over one gait cycle [0, 1) into a fixed resolution table, sampled with linear interpolation
+class SPIDERRIG_API FSpiderGaitTable
+{
+public:
+	void Bake(const UCurveFloat* Curve, const int32& InResolution);
+
+	// Whether the table was baked from this curve at this resolution, edits made to the curve in place since
+	// aren't noticed, the owner re-bakes on those
+	bool IsBakedFrom(const UCurveFloat* Curve, const int32& InResolution) const;
+
+	float Sample(const float& Phase) const;
+
+	// Sample many phases at once, phases have to be within [0, 1)
+	void SampleBatch(const float* Phases, float* OutValues, const int32& Count) const;
+
+	FORCEINLINE bool IsBaked() const
+	{
+		return Resolution > 0;
+	}
+
+private:
+	// one extra sample at the end of the cycle, so interpolation never wraps
+	TArray<float> Values;
+	int32 Resolution{0};
+	const UCurveFloat* BakedCurve{nullptr};
+};
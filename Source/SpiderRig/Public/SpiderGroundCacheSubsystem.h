@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "SpiderGroundCacheSubsystem.generated.h"
+
+class UPrimitiveComponent;
+
+// Latest ground sweep which started in a cell, kept as a plane so nearby legs can reuse it
+struct FSpiderGroundCell
+{
+	FVector Location{0};
+	FVector Normal{0};
+	FVector TraceDirection{0};
+	double Timestamp{0};
+	bool bHasGround{false};
+
+	// movable collision invalidates the cell as soon as it moves
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+	FTransform ComponentTransform;
+	bool bHasComponent{false};
+};
+
+// Ground under every spider of the world in a sparse hashed grid, filled on demand by the leg sweeps.
+// Legs of different spiders walking the same floor share the cells, so the number of sweeps follows the
+// covered floor area rather than the number of legs. Cells expire, and are dropped when their collision
+// moves or a level streams in or out.
+UCLASS()
+class SPIDERRIG_API USpiderGroundCacheSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	TMap<FIntVector, FSpiderGroundCell> Cells;
+	double NextPruneTime{0};
+
+	FIntVector GetCellKey(const FVector& LocationWorld) const;
+	bool IsCellValid(const FSpiderGroundCell& Cell, const double& Time) const;
+	void OnLevelChanged(ULevel* Level, UWorld* World);
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// Find the ground along a leg sweep, returns false when the sweep has to be issued
+	bool FindGround(const FVector& LegLocationWorld, const FVector& TraceOriginWorld, const FVector& TraceEndWorld,
+	                FVector& OutGroundLocationWorld, bool& bOutHasGround) const;
+
+	// Store the result of a leg sweep, a null hit means there was no ground, hits on pawns aren't shared
+	void StoreGround(const FVector& LegLocationWorld, const FVector& TraceOriginWorld, const FVector& TraceEndWorld,
+	                 const FHitResult* HitResult);
+
+	// Drop every cell within the box, e.g. after moving collision around
+	void Invalidate(const FBox& BoxWorld);
+	void InvalidateAll();
+
+	FORCEINLINE int32 GetCellCount() const
+	{
+		return Cells.Num();
+	}
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Number of legs solved together in a single SIMD register
+#define SPIDER_LEG_SOLVER_LANES 4
+
+// One bone of four leg chains in structure-of-arrays layout, one float per leg
+struct alignas(16) FSpiderLegSolverBone
+{
+	float LocationX[SPIDER_LEG_SOLVER_LANES];
+	float LocationY[SPIDER_LEG_SOLVER_LANES];
+	float LocationZ[SPIDER_LEG_SOLVER_LANES];
+	float RotationX[SPIDER_LEG_SOLVER_LANES];
+	float RotationY[SPIDER_LEG_SOLVER_LANES];
+	float RotationZ[SPIDER_LEG_SOLVER_LANES];
+	float RotationW[SPIDER_LEG_SOLVER_LANES];
+	float CosRotationLimit[SPIDER_LEG_SOLVER_LANES];
+};
+
+// Effector target of four legs in structure-of-arrays layout
+struct alignas(16) FSpiderLegSolverTarget
+{
+	float LocationX[SPIDER_LEG_SOLVER_LANES];
+	float LocationY[SPIDER_LEG_SOLVER_LANES];
+	float LocationZ[SPIDER_LEG_SOLVER_LANES];
+};
+
+// CCD solver which packs all legs of a rig in single precision and solves four of them per instruction,
+// it follows AnimationCore::SolveCCDIK: tail to root, root link fixed, per step rotation limit per bone
+class SPIDERRIG_API FSpiderLegSolver
+{
+public:
+	// Allocate the chains, shorter legs are padded with their tip bone
+	void Reset(const int32& InLegCount, const int32& InMaxChainLength);
+
+	void SetBone(const int32& LegIndex, const int32& BoneIndex, const FTransform& GlobalTransform,
+	             const float& RotationLimit);
+
+	// Fill the remaining bones of a leg with its tip, zero length links never rotate
+	void PadChain(const int32& LegIndex, const int32& ChainLength);
+
+	void SetTarget(const int32& LegIndex, const FVector& TargetGlobal);
+
+	// Aim a leg at its own tip, so it doesn't take part in the solve
+	void SkipLeg(const int32& LegIndex);
+
+	// Solve every leg, returns the largest number of iterations used by a group of legs
+	int32 Solve(const float& Precision, const int32& MaxIteration);
+
+	bool IsLegUpdated(const int32& LegIndex) const;
+	FTransform GetBoneTransform(const int32& LegIndex, const int32& BoneIndex) const;
+
+	FORCEINLINE int32 GetLegCount() const
+	{
+		return LegCount;
+	}
+
+	FORCEINLINE int32 GetMaxChainLength() const
+	{
+		return MaxChainLength;
+	}
+
+private:
+	int32 LegCount{0};
+	int32 MaxChainLength{0};
+	int32 GroupCount{0};
+
+	// [Group * MaxChainLength + Bone]
+	TArray<FSpiderLegSolverBone> Bones;
+	// [Group]
+	TArray<FSpiderLegSolverTarget> Targets;
+	TArray<int32> UpdatedLanes;
+	// [Leg * MaxChainLength + Bone], scale doesn't take part in the solve
+	TArray<FVector> Scales;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldCollision.h"
+
+// Async sweeps issued for a single leg, resolved on the next evaluation
+struct FSpiderLegTrace
+{
+	FTraceHandle GroundHandle;
+	FTraceHandle LedgeHandle;
+
+	// leg and root locations the sweeps are issued from
+	FVector RequestedLocationWorld{0};
+	FVector RootLocationWorld{0};
+	FVector TraceOriginWorld{0};
+	FVector TraceEndWorld{0};
+
+	// last resolved offset from the requested leg location to the ground
+	FVector GroundOffsetWorld{0};
+	bool bHasGround{false};
+
+	// the ground is the edge of a ledge, the leg holds on to where it grabbed it
+	FVector LedgeLocationWorld{0};
+	bool bIsLedge{false};
+	bool bShouldSubmit{false};
+
+	// the last ground sweep missed, the ledge sweep goes along with the next one
+	bool bShouldSweepLedge{false};
+};
+
+// Every leg of a rig in structure-of-arrays layout, per leg values are indexed by [Leg] and
+// the bones of all legs are packed back to back, indexed by [BoneOffsets[Leg] + Bone]
+struct SPIDERRIG_API FSpiderLegTable
+{
+	// Drop every leg, the storage is kept for the next build
+	void Reset();
+
+	// Append a leg with its IK control and chain bones, returns the leg index
+	int32 AddLeg(const int32& IKIndex, const TArray<int32>& ChainBoneIndices);
+
+	// Size and clear the runtime state once every leg was added
+	void Allocate();
+
+	FORCEINLINE int32 Num() const
+	{
+		return IKIndices.Num();
+	}
+
+	FORCEINLINE int32 GetMaxBoneCount() const
+	{
+		return MaxBoneCount;
+	}
+
+	FORCEINLINE const int32* GetBoneIndices(const int32& LegIndex) const
+	{
+		return &BoneIndices[BoneOffsets[LegIndex]];
+	}
+
+	FORCEINLINE FTransform* GetSolvedChain(const int32& LegIndex)
+	{
+		return &SolvedChains[BoneOffsets[LegIndex]];
+	}
+
+	FORCEINLINE const FTransform* GetSolvedChain(const int32& LegIndex) const
+	{
+		return &SolvedChains[BoneOffsets[LegIndex]];
+	}
+
+	// rig indices, [Leg]
+	TArray<int32> IKIndices;
+	TArray<int32> BoneOffsets;
+	TArray<int32> BoneCounts;
+	TArray<bool> FollowsSpine;
+	TArray<FVector> RestLocationsGlobal;
+
+	// rig indices of every chain bone, [BoneOffsets[Leg] + Bone]
+	TArray<int32> BoneIndices;
+
+	// gait sampling, [Leg]
+	TArray<float> GaitPhases;
+	TArray<float> StickGroundFactors;
+	TArray<float> OffsetFactors;
+
+	// placement, [Leg]
+	TArray<FVector> GroundLocationsWorld;
+	TArray<FVector> LocationsWorld;
+	TArray<FVector> TargetsGlobal;
+	TArray<FVector> FinalLocationsGlobal;
+	TArray<FSpiderLegTrace> Traces;
+
+	// solve state, [Leg]
+	TArray<FTransform> RootTransforms;
+	TArray<float> AccumulatedDeltaTime;
+	TArray<bool> ActiveState;
+	TArray<bool> SolveState;
+	TArray<bool> SolvedState;
+	TArray<FVector> SolvedTargets;
+
+	// previously solved chains relative to the leg root, [BoneOffsets[Leg] + Bone]
+	TArray<FTransform> SolvedChains;
+
+private:
+	int32 MaxBoneCount{0};
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "SkeletalMeshComponentBudgeted.h"
+#include "SpiderMeshComponent.generated.h"
+
+#include <atomic>
+
+class USpiderRig;
+
+// Skeletal mesh of a spider, ticked within the Animation Budget Allocator's budget like any other budgeted mesh.
+// Rigs read whether the allocator asked for reduced work, and report the time they spend off the game thread
+// (parallel evaluation, crowd solves) which the allocator can't measure on its own.
+// The mesh also runs the game thread side of its rig, the pre-update before the animation is evaluated and the
+// post-update once the evaluation completed, so the rig itself can evaluate on the animation worker threads.
+UCLASS(ClassGroup = Rendering, meta = (BlueprintSpawnableComponent))
+class SPIDERRIG_API USpiderMeshComponent : public USkeletalMeshComponentBudgeted
+{
+	GENERATED_BODY()
+
+	std::atomic<uint64> PendingRigCycles{0};
+	bool bIsWorkReduced{false};
+	TWeakObjectPtr<USpiderRig> SpiderRig;
+
+	void OnReduceWorkChanged(USkeletalMeshComponentBudgeted* Component, bool bInReduceWork);
+
+	// Whether this tick evaluates the animation, the allocator decides before any component ticks
+	bool WillEvaluateThisTick() const;
+
+public:
+	USpiderMeshComponent(const FObjectInitializer& ObjectInitializer);
+
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType,
+	                           FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void CompleteParallelAnimationEvaluation(bool bDoPostAnimEvaluation) override;
+
+	// Set by the rig on its first evaluation, only one rig per mesh is updated
+	FORCEINLINE void SetSpiderRig(USpiderRig* Rig)
+	{
+		SpiderRig = Rig;
+	}
+
+	// Thread safe, added to the tick time reported to the allocator on the next tick
+	FORCEINLINE void AddRigCycles(const uint64& Cycles)
+	{
+		PendingRigCycles += Cycles;
+	}
+
+	FORCEINLINE bool IsWorkReduced() const
+	{
+		return bIsWorkReduced;
+	}
+};
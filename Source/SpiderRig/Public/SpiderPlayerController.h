@@ -6,6 +6,7 @@
 
 class UInputMappingContext;
 class ASpiderCharacter;
+struct FStreamableHandle;
 
 UCLASS()
 class SPIDERRIG_API ASpiderPlayerController : public APlayerController
@@ -15,12 +16,24 @@ class SPIDERRIG_API ASpiderPlayerController : public APlayerController
 	TArray<uint32> BindingHandles;
 	TObjectPtr<ASpiderCharacter> PossessedCharacter{nullptr};
 
-	UFUNCTION()
+	// The mapping context is loaded once the controller begins play and bound to its own input component,
+	// possessions only swap the character the inputs are applied to
+	UPROPERTY(Transient)
+	TObjectPtr<UInputMappingContext> LoadedMappingContext{nullptr};
+	TSharedPtr<FStreamableHandle> MappingContextHandle;
+	TWeakObjectPtr<UInputComponent> BoundInputComponent;
+
+	void OnMappingContextLoaded();
+
+	// Bound natively to the actions named after them
 	void MoveInputAction(const FInputActionValue& Value);
-	UFUNCTION()
 	void LookInputAction(const FInputActionValue& Value);
-	UFUNCTION()
-	void JumpInputAction(const FInputActionValue& Value) const;
+	void JumpInputAction(const FInputActionValue& Value);
+
+	// Triggers only collect the input, it is applied to the character once per frame after processing the input
+	FVector2D PendingMoveInput{0};
+	FVector2D PendingLookInput{0};
+	bool bHasPendingMoveInput{false};
 
 	FVector2D MoveInputValue{0};
 	FVector2D LookInputValue{0};
@@ -28,6 +41,10 @@ class SPIDERRIG_API ASpiderPlayerController : public APlayerController
 protected:
 	virtual void OnPossess(APawn* NewPawn) override;
 	virtual void OnUnPossess() override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void SetupInputComponent() override;
+	virtual void PostProcessInput(const float DeltaTime, const bool bGamePaused) override;
 
 	void SetupInputSystem() const;
 	void BindInputs();
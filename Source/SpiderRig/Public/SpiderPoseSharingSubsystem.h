@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "SpiderPoseSharingSubsystem.generated.h"
+
+class USpiderRig;
+
+enum class ESpiderGaitBucket : uint8
+{
+	Stall,
+	Walk,
+	Run,
+	Falling,
+};
+
+enum class ESpiderPoseRole : uint8
+{
+	// evaluates on its own and shares nothing
+	None,
+	// evaluates on its own and records its pose for the others of its bucket
+	Leader,
+	// copies the recorded pose of its bucket at its own gait phase
+	Follower,
+};
+
+// Poses of one rig class in one gait state, recorded by its leader over a whole gait cycle.
+// Slots hold the driven bones of the rig in rig space, [Slot * PoseSize + Bone].
+struct FSpiderPoseBucket
+{
+	const UClass* RigClass{nullptr};
+	ESpiderGaitBucket Gait{ESpiderGaitBucket::Stall};
+
+	TWeakObjectPtr<USpiderRig> Leader;
+	double LeaderSeenTime{0};
+	bool bIsLeaderFar{false};
+
+	int32 SlotCount{1};
+	int32 PoseSize{0};
+	TArray<FTransform> Slots;
+	TBitArray<> FilledSlots;
+	int32 FilledCount{0};
+
+	FORCEINLINE bool IsReady() const
+	{
+		return PoseSize > 0 && FilledCount == SlotCount;
+	}
+};
+
+// Pose sharing for distant spiders, in the spirit of the Animation Sharing plugin. For every rig class and
+// gait state one leader rig evaluates on its own and records its pose over the gait cycle, far spiders of the
+// same class and state copy the recorded pose at their own phase instead of tracing and solving their legs.
+// The cost scales with the number of buckets, not with the number of spiders. A bucket with only far spiders
+// still needs one of them to lead at full quality, and crowd rigs never lead, a bucket of crowd rigs alone
+// doesn't share at all.
+UCLASS()
+class SPIDERRIG_API USpiderPoseSharingSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	TArray<FSpiderPoseBucket> Buckets;
+
+	int32 FindOrAddBucket(const UClass* RigClass, const ESpiderGaitBucket& Gait);
+
+public:
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	static ESpiderGaitBucket ClassifyGait(const float& HorizontalSpeed, const bool& bIsFalling);
+
+	// Game thread, once per evaluation. Returns the role of the rig this evaluation and the bucket it is in.
+	ESpiderPoseRole RequestRole(USpiderRig* Rig, const ESpiderGaitBucket& Gait, const int32& LOD,
+	                            const bool& bCanLead, int32& OutBucketIndex);
+
+	// Game thread, the pose of a follower at its gait phase, false if the bucket has nothing to share
+	bool SamplePose(const int32& BucketIndex, const float& Phase, TArray<FTransform>& OutPose) const;
+
+	// Game thread, records the pose of a leader at its gait phase
+	void PublishPose(const USpiderRig* Rig, const int32& BucketIndex, const float& Phase,
+	                 const TArray<FTransform>& Pose);
+};
@@ -3,17 +3,101 @@
 #include "ControlRig.h"
 #include "CCDIK.h"
 #include "FSpiderLegDef.h"
+#include "FSpiderLODDef.h"
 #include "FSpiderSpineDef.h"
+#include "SpiderGaitTable.h"
+#include "SpiderLegSolver.h"
+#include "SpiderLegTable.h"
+#include "SpiderEffectsComponent.h"
+#include "SpiderGaitNetState.h"
+#include "SpiderPoseSharingSubsystem.h"
 #include "Engine/SpringInterpolator.h"
 #include "SpiderRig.generated.h"
 
-#define MAX_SPIDER_LEG_LENGTH 8
-#define MAX_SPIDER_LEG_BONE_LENGTH 8
-
 class USpiderEffectsComponent;
 class ACharacter;
+class ASpiderCharacter;
 class UCurveFloat;
 class UCharacterMovementComponent;
+class USpiderCrowdSubsystem;
+class USpiderGroundCacheSubsystem;
+class USpiderFootholdSubsystem;
+class USpiderMeshComponent;
+
+UENUM(BlueprintType)
+enum class ESpiderLegSolver : uint8
+{
+	// All legs packed together and solved with SIMD math
+	Batched UMETA(DisplayName = "Batched"),
+	// One leg at a time with AnimationCore::SolveCCDIK
+	CCDIK UMETA(DisplayName = "CCDIK"),
+};
+
+// Per evaluation values handed from the gather phase to the solve phase
+struct FSpiderRigFrame
+{
+	float DeltaTime{0};
+	float ElapsedTime{0};
+	uint32 EvaluationIndex{0};
+	bool bIsAirborne{false};
+
+	// level of detail and its blended settings
+	int32 LOD{0};
+	FSpiderLODDef LODSettings;
+
+	FVector LocalVelocity{0};
+	float HorizontalSpeed{0};
+	float VerticalSpeed{0};
+	float OneOnMovement{0};
+	float OneOnStall{0};
+
+	FVector SpineLocationGlobal{0};
+	float SpineDeltaTime{0};
+	float LegDeltaTime{0};
+};
+
+// Everything the rig reads from the character and the world, snapshot on the game thread before evaluating
+// so the evaluation itself can run on the animation worker threads
+struct FSpiderRigInputs
+{
+	FTransform ComponentTransform;
+	FVector VelocityWorld{0};
+	FVector ActorLocationWorld{0};
+	float MaxWalkSpeed{0};
+	float ElapsedTime{0};
+	int32 TargetLOD{0};
+	float LODBlendTime{0};
+	bool bIsFalling{false};
+	bool bIsPawnControlled{false};
+
+	// gait replicated by the server, simulated proxies only, NetGaitTime estimates when the server sent it
+	FSpiderGaitNetState NetGait;
+	float NetGaitTime{0};
+	bool bHasNewNetGait{false};
+	bool bIsNetDriven{false};
+
+	// copy the pose of the bucket's leader instead of tracing and solving
+	bool bUseSharedPose{false};
+};
+
+// Side effects of an evaluation, applied on the game thread once it is done
+struct FSpiderRigOutputs
+{
+	TArray<FSpiderLandingRequest> LandingRequests;
+	bool bShouldResetVelocity{false};
+
+	// level of detail the evaluation ended on
+	int32 LOD{0};
+	bool bAreLegsFrozen{false};
+};
+
+// Bone transform waiting for the commit phase
+struct FSpiderBoneWrite
+{
+	int32 BoneIndex{INDEX_NONE};
+	FTransform TransformGlobal;
+	bool bAffectChildren{false};
+};
 
 UCLASS(Blueprintable)
 class SPIDERRIG_API USpiderRig : public UControlRig
@@ -23,38 +107,131 @@ class SPIDERRIG_API USpiderRig : public UControlRig
 	bool InitializeLegs();
 	bool InitializeSpine();
 	bool InitializeVariables();
-	void SetLegLocation(const int32& LegIndex, const FVector& NewLegLocationGlobal, const float& Dt);
+	void BakeGaitTables();
+
+	// game thread side of an evaluation, inputs and traces before it and its side effects after it
+	void ResolveGroundedLegs();
+
+	// gather phase, character inputs and curve sampling
+	void GatherStep(FSpiderRigFrame& Frame);
+	void GatherFrame(FSpiderRigFrame& Frame);
+	void GatherLOD(FSpiderRigFrame& Frame);
+	void GatherNetGait(const FSpiderRigFrame& Frame);
+	int32 CalculateLOD() const;
+	FSpiderLODDef GetLODDef(const int32& LOD) const;
+	void GatherFallStart(const FSpiderRigFrame& Frame);
+	void GatherLanding(FSpiderRigFrame& Frame, const FVector& SpineLocationWorld);
+	void GatherFallingLegs(FSpiderRigFrame& Frame);
+	void GatherGroundedLegs(FSpiderRigFrame& Frame);
+	void ReseedLegs();
+
+	// solve phase, spine once then the legs against the new spine
+	void SolveFrame(const FSpiderRigFrame& Frame);
 	void SetSpineTransform(const FVector& SpineLocationGlobal, const FRotator& RotationGlobal, const float& Dt);
+	void SetLegLocation(const int32& LegIndex, const FVector& NewLegLocationGlobal, const float& Dt);
+	void SolveLegCCDIK(const int32& LegIndex);
+	void SolveLegsBatched();
+	bool ShouldSolveLeg(const int32& LegIndex) const;
+	FTransform GetLegBoneTransform(const int32& LegIndex, const int32& BoneIndex) const;
+	void StoreSolvedLeg(const int32& LegIndex);
+
+	// commit phase, every bone is written in a single pass
+	void QueueBoneTransform(const int32& BoneIndex, const FTransform& TransformGlobal, const bool& bAffectChildren);
+	void CommitBoneTransforms();
+
+	// fixed timestep, the simulation steps at a fixed rate and the driven bones are interpolated in between
+	void ExecuteFixedTimestep(const float& DeltaTime, const float& ElapsedTime);
+	void CaptureFixedStepPose(TArray<FTransform>& OutPose) const;
+	void SetFixedStepPose(const TArray<FTransform>& Pose);
+
+	// pose sharing, leaders record their pose and far followers copy it at their own phase
+	void UpdatePoseSharing();
+	void ExecuteSharedPose(const float& DeltaTime, const float& ElapsedTime);
+	void CaptureLeaderPose();
 
 	FORCEINLINE FVector RotateWorldToGlobal(const FVector& LocationWorld) const
 	{
-		return ParentSceneComponent->GetComponentRotation().UnrotateVector(LocationWorld);
+		return Inputs.ComponentTransform.GetRotation().UnrotateVector(LocationWorld);
 	}
 
 	FORCEINLINE FVector RotateGlobalToWorld(const FVector& LocationGlobal) const
 	{
-		return ParentSceneComponent->GetComponentRotation().RotateVector(LocationGlobal);
+		return Inputs.ComponentTransform.GetRotation().RotateVector(LocationGlobal);
 	}
 
 	FORCEINLINE FVector TransformGlobalToWorld(const FVector& LocationGlobal) const
 	{
-		return ParentSceneComponent->GetComponentTransform().TransformPosition(LocationGlobal);
+		return Inputs.ComponentTransform.TransformPosition(LocationGlobal);
 	}
 
 	FORCEINLINE FVector TransformWorldToGlobal(const FVector& LocationWorld) const
 	{
-		return ParentSceneComponent->GetComponentTransform().InverseTransformPosition(LocationWorld);
+		return Inputs.ComponentTransform.InverseTransformPosition(LocationWorld);
 	}
 
+	// Convert many points at once, the component transform is only read once
+	void TransformGlobalToWorld(const TArray<FVector>& LocationsGlobal, TArray<FVector>& OutLocationsWorld) const;
+	void TransformWorldToGlobal(const TArray<FVector>& LocationsWorld, TArray<FVector>& OutLocationsGlobal) const;
+
+	void CalculateLegTrace(
+		const FVector& LegLocationWorld,
+		const FVector& RootLocationWorld,
+		const FVector& UpVectorWorld,
+		FVector& TraceOriginWorld,
+		FVector& TraceEndWorld
+	) const;
+
 	bool TraceSingleLeg(
 		FVector& LegLocationWorld,
 		const FVector& RootLocationWorld,
+		const FVector& UpVectorWorld,
+		FHitResult& OutHitResult,
+		bool& bOutIsLedge
+	) const;
+
+	bool ResolveFootholdLegGround(
+		FSpiderLegTrace& Trace,
+		const FVector& LegLocationWorld,
+		const FVector& RootLocationWorld,
 		const FVector& UpVectorWorld
 	) const;
 
+	bool ResolveCachedLegGround(
+		FSpiderLegTrace& Trace,
+		const FVector& LegLocationWorld,
+		const FVector& RootLocationWorld,
+		const FVector& UpVectorWorld
+	) const;
+
+	bool ResolveLegGround(
+		const int32& LegIndex,
+		FVector& LegLocationWorld,
+		const FVector& RootLocationWorld,
+		const FVector& UpVectorWorld,
+		const bool& bIsTraceDue
+	);
+
+	void SubmitAsyncLegTraces(const FVector& UpVectorWorld);
+
+public:
+	// Called by the spider mesh on the game thread around every evaluation, other hosts evaluating on the game
+	// thread get them called from Execute
+	void PreUpdate();
+	void PostUpdate();
+
 protected:
 	virtual bool Execute(const FName& InEventName) override;
 	virtual void Initialize(bool bRequestInit) override;
+	virtual void BeginDestroy() override;
+
+	// crowd evaluation, the frame is gathered here and solved by the crowd subsystem
+	friend class USpiderCrowdSubsystem;
+	void SolveCrowdFrame();
+
+	FORCEINLINE bool HasPendingCrowdFrame() const
+	{
+		return bHasPendingCrowdFrame;
+	}
 
 private:
 	// whether the bones are correctly configured or not
@@ -63,8 +240,6 @@ private:
 
 	// cache rig indices for faster lookup
 	int32 SpineIndex{-1};
-	int32 LegIndices[MAX_SPIDER_LEG_LENGTH][MAX_SPIDER_LEG_BONE_LENGTH + 1];
-	int32 LegLength{0};
 
 
 	// falling related properties
@@ -72,33 +247,86 @@ private:
 	float JumpImpact{0};
 	float JumpZStart{0};
 	bool bIsFallStarted{false};
+	uint8 LandingCount{0};
 
 
 	// time related properties
 	float PrevFrame{0};
+	uint32 EvaluationCounter{0};
+	uint32 GroundEvaluationCounter{0};
+
+
+	// game thread snapshot and side effects, handed over between the pre-update, Execute and the post-update
+	FSpiderRigInputs Inputs;
+	FSpiderRigOutputs Outputs;
+	bool bHasInputs{false};
+	bool bHasPreUpdated{false};
+
+
+	// fixed timestep related properties, poses hold the spine then every leg bone, [1 + BoneOffsets[Leg] + Bone]
+	bool bHasFixedStepPose{false};
+	float FixedStepAccumulator{0};
+	float FixedStepElapsedTime{0};
+	TArray<FTransform> PrevFixedStepPose;
+	TArray<FTransform> FixedStepPose;
+	TArray<FTransform> InterpolatedFixedStepPose;
+
 
+	// level of detail related properties
+	int32 CurrentLOD{0};
+	float LODBlendAlpha{1};
+	FSpiderLODDef BlendFromLOD;
+	FSpiderLODDef BlendedLOD;
+	int32 EffectiveIKSolveIteration{0};
+	float EffectiveIKPrecision{0};
+
+	// copies of the evaluation's level of detail for the game thread, updated in the post-update
+	int32 GameThreadLOD{0};
+	bool bGameThreadLegsFrozen{false};
+
+
+	// gait curves baked at initialization
+	FSpiderGaitTable ToeStickGroundTable;
+	FSpiderGaitTable ToeOffsetTable;
+#if WITH_EDITOR
+	bool bGaitTablesDirty{false};
+	FDelegateHandle CurveModifiedHandle;
+#endif
 
 	// movement related properties
 	float LastMovementTimestamp{0};
 	float LaggedHorizontalSpeed{0};
 	float MotorValue{0};
 
+	// replication related properties, what is left to correct of the gait towards the server's
+	uint32 NetGaitSerial{0};
+	float NetPhaseError{0};
+	float NetSpeedError{0};
+
 	// spine related properties
 	FVector InitialSpineLocationGlobal{0};
 	FVectorRK4SpringInterpolator SpineSpringInterpolator;
 	FRotator FinalSpineRotation{0};
 
-	// legs related properties
+	// legs related properties, rig indices and per leg state of every leg
+	FSpiderLegTable LegTable;
 	TArray<float> RotationLimitsPerItem;
 	TArray<FCCDIKChainLink> TemporaryChain;
-	TArray<FVector> LegLocationsWorld;
-	TArray<bool> LegState;
-	TArray<FVector> FinalLegLocationsGlobal;
+	FSpiderLegSolver LegSolver;
+	TArray<FSpiderBoneWrite> BoneWrites;
+
+	// legs stopped following the ground (frozen or copying a shared pose), re-seeded on the next grounded gather
+	bool bAreLegsStale{false};
+
+	// trace related properties, reused across frames
+	FCollisionQueryParams TraceQueryParams;
+	FCollisionShape TraceCollisionShape;
 
 
 	// pre-initialized properties
 	AActor* ParentActor{nullptr};
 	ACharacter* ParentCharacter{nullptr};
+	ASpiderCharacter* SpiderCharacter{nullptr};
 	UCharacterMovementComponent* CharacterMovementComponent{nullptr};
 	URigHierarchy* RigHierarchy{nullptr};
 	USpiderEffectsComponent* SpiderEffects;
@@ -108,6 +336,31 @@ private:
 	USceneComponent* ParentSceneComponent{nullptr};
 	UWorld* LivingWorld{nullptr};
 
+	// budgeted mesh the rig runs on, null when hosted by any other component
+	USpiderMeshComponent* SpiderMesh{nullptr};
+
+	// ground shared with the other spiders of the world
+	USpiderGroundCacheSubsystem* GroundCache{nullptr};
+
+	// footholds baked from the static collision of the loaded levels
+	USpiderFootholdSubsystem* FootholdSubsystem{nullptr};
+
+	// crowd related properties
+	TWeakObjectPtr<USpiderCrowdSubsystem> CrowdSubsystem;
+	FSpiderRigFrame PendingCrowdFrame;
+	bool bHasPendingCrowdFrame{false};
+	bool bHasSolvedCrowdFrame{false};
+
+	// pose sharing related properties, the shared pose is sampled in the pre-update and the leader pose
+	// published in the post-update, the buckets are only ever touched on the game thread
+	USpiderPoseSharingSubsystem* PoseSharing{nullptr};
+	ESpiderPoseRole PoseRole{ESpiderPoseRole::None};
+	int32 PoseBucketIndex{INDEX_NONE};
+	TArray<FTransform> SharedPose;
+	TArray<FTransform> LeaderPose;
+	float LeaderPosePhase{0};
+	bool bHasLeaderPose{false};
+
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Legs"), Category = "Rig Config")
 	TArray<FSpiderLegDef> Legs;
@@ -121,6 +374,9 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Toe Stick To Ground Timeline"), Category = "Movement")
 	TObjectPtr<UCurveFloat> ToeStickGroundTimeline;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Timeline Resolution", ClampMin = 2), Category = "Movement")
+	int32 GaitTableResolution = 256;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Minimum Leg Spread"), Category = "Falling")
 	float FallingMinLegSpread = 0.1f;
 
@@ -178,6 +434,43 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Toe Trace Radius"), Category = "Traces")
 	float ToeTraceRadius = 5.0f;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Crowd Evaluation"), Category = "Rig Config")
+	bool bUseCrowdEvaluation = false;
+
+	// Step gait, spine and legs at a fixed rate and interpolate the pose in between, crowd rigs always step per frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Fixed Timestep"), Category = "Rig Config")
+	bool bUseFixedTimestep = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Fixed Timestep Rate", ClampMin = 1, Units = "Hz"), Category = "Rig Config")
+	float FixedTimestepRate = 30.0f;
+
+	// Steps allowed in a single evaluation to catch up after a hitch, the remaining time is dropped
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Max Fixed Sub Steps", ClampMin = 1), Category = "Rig Config")
+	int32 MaxFixedSubSteps = 4;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Async Traces"), Category = "Traces")
+	bool bUseAsyncTraces = false;
+
+	// Read the ground from the world wide cache first and only sweep on a miss
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Shared Ground Cache"), Category = "Traces")
+	bool bUseGroundCache = false;
+
+	// Resolve the ground over static collision from the baked foothold maps, sweeps are left for movable collision
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Baked Footholds"), Category = "Traces")
+	bool bUseFootholdMap = false;
+
+	// Send the gait to simulated proxies on the server, and converge to the received one on the clients
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Replicate Gait"), Category = "Network")
+	bool bReplicateGait = true;
+
+	// Also send which legs stick to the ground, a byte more per update
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Replicate Contact Hints"), Category = "Network")
+	bool bReplicateContactHints = false;
+
+	// How fast clients close the gap between their gait and the server's
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Gait Correction Speed", ClampMin = 0), Category = "Network")
+	float NetGaitCorrectionSpeed = 5.0f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Toe Placement Lag"), Category = "Movement")
 	float ToePlacementLagSpeed = 10.0f;
 
@@ -187,6 +480,30 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "IK Iteration"), Category = "Rig Config")
 	int32 IKSolveIteration = 15;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "IK Rotation Limit"), Category = "Rig Config")
+	float IKRotationLimit = 10.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "IK Warm Start"), Category = "Rig Config")
+	bool bIKWarmStart = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "IK Skip Threshold"), Category = "Rig Config")
+	float IKSkipThreshold = 0.1f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "IK Solver"), Category = "Rig Config")
+	ESpiderLegSolver IKSolver = ESpiderLegSolver::Batched;
+
+	// Cheaper tiers after the full quality one, picked by spiderrig.LOD.* console variables
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "LODs"), Category = "LOD")
+	TArray<FSpiderLODDef> LODs = {
+		{8, 0.5f, 2, 1, false},
+		{4, 1.0f, 4, 2, false},
+		{1, 2.0f, 8, 4, true},
+	};
+
+	// Copy the pose of a leader spider of the same rig and gait once far enough, see spiderrig.PoseSharing.*
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Pose Sharing"), Category = "LOD")
+	bool bUsePoseSharing = false;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(DisplayName = "Toe Lag"), Category = "Falling")
 	float ToeFallingLag = 1.0f;
 	
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiderRigStats.h"
+
+#include <atomic>
+
+// Counters are only meant for profiling and benchmarking, shipping builds don't pay for them
+#define SPIDERRIG_WITH_COUNTERS !UE_BUILD_SHIPPING
+
+#if SPIDERRIG_WITH_COUNTERS
+
+// Work done by every spider rig since the last reset, crowd rigs solve on the worker threads so every counter is atomic
+struct SPIDERRIG_API FSpiderRigCounters
+{
+	// cpu time spent evaluating rigs, crowd solves on the workers included
+	std::atomic<uint64> ExecuteCycles{0};
+	std::atomic<int32> ExecuteCount{0};
+
+	// cpu time spent on the game thread ahead of the evaluations, traces and lookups included
+	std::atomic<uint64> PreUpdateCycles{0};
+
+	// named after the stats they are counted along with
+	std::atomic<int32> SweepsIssued{0};
+	// iterations are only known for the batched solver
+	std::atomic<int32> IKIterations{0};
+
+	std::atomic<int32> IKSolveCount{0};
+
+	static FSpiderRigCounters& Get();
+	void Reset();
+};
+
+// Adds the cycles spent in the enclosing scope to a counter
+struct FSpiderRigCycleCounterScope
+{
+	explicit FSpiderRigCycleCounterScope(std::atomic<uint64>& InCounter)
+		: Counter(InCounter), StartCycles(FPlatformTime::Cycles64())
+	{
+	}
+
+	~FSpiderRigCycleCounterScope()
+	{
+		Counter += FPlatformTime::Cycles64() - StartCycles;
+	}
+
+private:
+	std::atomic<uint64>& Counter;
+	uint64 StartCycles;
+};
+
+#define SPIDERRIG_COUNTER_ADD(Counter, Value) (FSpiderRigCounters::Get().Counter += (Value))
+#define SPIDERRIG_CYCLE_COUNTER_SCOPE(Counter) \
+	FSpiderRigCycleCounterScope ANONYMOUS_VARIABLE(SpiderRigCycleCounter)(FSpiderRigCounters::Get().Counter)
+
+#else
+
+#define SPIDERRIG_COUNTER_ADD(Counter, Value)
+#define SPIDERRIG_CYCLE_COUNTER_SCOPE(Counter)
+
+#endif
+
+// Per frame counter of the stat group and the csv profile which the benchmark records as well
+#define SPIDERRIG_INC_BENCHMARK_COUNTER_BY(Name, Value) \
+	do \
+	{ \
+		SPIDERRIG_INC_COUNTER_BY(Name, Value); \
+		SPIDERRIG_COUNTER_ADD(Name, Value); \
+	} \
+	while (0)
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "HAL/LowLevelMemTracker.h"
+
+// Stats, csv timings and memory tags of the module, the engine compiles all of them out in shipping.
+// "stat SpiderRig" shows the stat group, "csvprofile start" records the SpiderRig category.
+
+DECLARE_STATS_GROUP(TEXT("SpiderRig"), STATGROUP_SpiderRig, STATCAT_Advanced);
+
+// rig phases
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Execute"), STAT_SpiderRig_Execute, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pre Update"), STAT_SpiderRig_PreUpdate, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Gather"), STAT_SpiderRig_Gather, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Gait Sampling"), STAT_SpiderRig_GaitSampling, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Solve"), STAT_SpiderRig_Solve, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Commit"), STAT_SpiderRig_Commit, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trace Single Leg"), STAT_SpiderRig_TraceSingleLeg, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Submit Async Traces"), STAT_SpiderRig_SubmitAsyncTraces, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Set Leg Location"), STAT_SpiderRig_SetLegLocation, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Set Spine Transform"), STAT_SpiderRig_SetSpineTransform, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Solve Legs Batched"), STAT_SpiderRig_SolveLegsBatched, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Foothold"), STAT_SpiderRig_FindFoothold, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pose Sharing"), STAT_SpiderRig_PoseSharing, STATGROUP_SpiderRig, SPIDERRIG_API);
+
+// camera and effects
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Camera Update"), STAT_SpiderRig_CameraUpdate, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Camera Collision"), STAT_SpiderRig_CameraCollision, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Camera Zones"), STAT_SpiderRig_CameraZones, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Effect Spawn"), STAT_SpiderRig_EffectSpawn, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Effect Budget"), STAT_SpiderRig_EffectBudget, STATGROUP_SpiderRig, SPIDERRIG_API);
+
+// swarms
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Swarm Gait"), STAT_SpiderRig_SwarmGait, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Swarm Update"), STAT_SpiderRig_SwarmUpdate, STATGROUP_SpiderRig, SPIDERRIG_API);
+
+// per frame counters
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sweeps Issued"), STAT_SpiderRig_SweepsIssued, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sweeps Hit"), STAT_SpiderRig_SweepsHit, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sweeps Missed"), STAT_SpiderRig_SweepsMissed, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ledge Fallbacks"), STAT_SpiderRig_LedgeFallbacks, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("IK Iterations"), STAT_SpiderRig_IKIterations, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Effect Spawns"), STAT_SpiderRig_EffectSpawns, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Effect Requests"), STAT_SpiderRig_EffectRequests, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Effects Dropped"), STAT_SpiderRig_EffectsDropped, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ground Cache Hits"), STAT_SpiderRig_GroundCacheHits, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ground Cache Misses"), STAT_SpiderRig_GroundCacheMisses, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Foothold Hits"), STAT_SpiderRig_FootholdHits, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Foothold Misses"), STAT_SpiderRig_FootholdMisses, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Swarm Promotions"), STAT_SpiderRig_SwarmPromotions, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Swarm Demotions"), STAT_SpiderRig_SwarmDemotions, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Shared Poses"), STAT_SpiderRig_SharedPoses, STATGROUP_SpiderRig, SPIDERRIG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pose Leaders"), STAT_SpiderRig_PoseLeaders, STATGROUP_SpiderRig, SPIDERRIG_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(SPIDERRIG_API, SpiderRig);
+
+LLM_DECLARE_TAG_API(SpiderRig, SPIDERRIG_API);
+
+// Cycle stat, Insights cpu event and csv timing of a scope at once. Both are scoped declarations which
+// can't be wrapped into a single statement, the block around them decides how long they time, so it always
+// has to be a braced block of its own, never the unbraced body of an if or a loop.
+#define SPIDERRIG_SCOPE_CYCLE_COUNTER(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_SpiderRig_##Name); \
+	CSV_SCOPED_TIMING_STAT(SpiderRig, Name)
+
+// Per frame counter in both the stat group and the csv profile
+#define SPIDERRIG_INC_COUNTER_BY(Name, Value) \
+	do \
+	{ \
+		INC_DWORD_STAT_BY(STAT_SpiderRig_##Name, Value); \
+		CSV_CUSTOM_STAT(SpiderRig, Name, static_cast<int32>(Value), ECsvCustomStatOp::Accumulate); \
+	} \
+	while (0)
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "SpiderGaitTable.h"
+#include "SpiderSwarmConfig.generated.h"
+
+class ASpiderCharacter;
+class UCurveFloat;
+class UStaticMesh;
+
+// Look and gait of a background swarm. Swarm spiders are Mass entities drawn as instances of a single mesh,
+// the ones close enough to a player are promoted to a full spider character.
+UCLASS(BlueprintType)
+class SPIDERRIG_API USpiderSwarmConfig : public UDataAsset
+{
+	GENERATED_BODY()
+
+	FSpiderGaitTable ToeStickGroundTable;
+	FSpiderGaitTable ToeOffsetTable;
+
+public:
+	// Bake the gait curves, done on the game thread before any entity of the swarm is processed
+	void BakeGaitTables();
+
+	FORCEINLINE const FSpiderGaitTable& GetToeStickGroundTable() const
+	{
+		return ToeStickGroundTable;
+	}
+
+	FORCEINLINE const FSpiderGaitTable& GetToeOffsetTable() const
+	{
+		return ToeOffsetTable;
+	}
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rendering")
+	TObjectPtr<UStaticMesh> Mesh;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Promotion")
+	TSubclassOf<ASpiderCharacter> SpiderClass;
+
+	// Entities closer than this to a player become full spider characters
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = 0, Units = "cm"), Category = "Promotion")
+	float PromoteDistance = 1500.0f;
+
+	// Characters further than this from every player go back to being entities, larger than the promote
+	// distance so spiders on the edge don't flip every frame
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = 0, Units = "cm"), Category = "Promotion")
+	float DemoteDistance = 2000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = 0), Category = "Promotion")
+	int32 MaxPromoted = 16;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	TObjectPtr<UCurveFloat> ToeOffsetTimeline;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	TObjectPtr<UCurveFloat> ToeStickGroundTimeline;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = 2), Category = "Movement")
+	int32 GaitTableResolution = 64;
+
+	// Only the first eight legs are tracked by the foot contacts
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = 1, ClampMax = 8), Category = "Movement")
+	int32 LegCount = 8;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float MaxWalkSpeed = 160.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float ThrottleMultiplier = 3.01f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float LazyLag = 0.1f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float LazyStallLagMultiplier = 10.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float MovementTransitionDuration = 0.25f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float AnimationOffCycleCoefficient = 0.45f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float StepHeight = 15.0f;
+
+	// The ground is traced from this far above the spider's feet
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = 0, Units = "cm"), Category = "Ground")
+	float GroundTraceHeight = 50.0f;
+
+	// and down to this far below them, spiders with no ground in between keep their height
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = 0, Units = "cm"), Category = "Ground")
+	float GroundTraceDepth = 200.0f;
+
+	// How fast spiders settle on the traced ground, 0 snaps them to it
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = 0), Category = "Ground")
+	float GroundFollowSpeed = 10.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = 0, Units = "Hz"), Category = "Spine")
+	float SpineSpringFrequency = 4.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = 0), Category = "Spine")
+	float SpineSpringDampingRatio = 0.25f;
+};
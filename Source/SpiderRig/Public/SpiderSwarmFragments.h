@@ -0,0 +1,83 @@
+#pragma once
+
+#include "MassEntityTypes.h"
+#include "WorldCollision.h"
+#include "SpiderSwarmFragments.generated.h"
+
+class USpiderSwarmConfig;
+
+// Where a swarm spider is heading, written by whatever steers the swarm
+USTRUCT()
+struct SPIDERRIG_API FSpiderSwarmMotionFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FVector Velocity{0};
+};
+
+// Gait of a swarm spider, the same motor and lagged speed the rig runs on
+USTRUCT()
+struct SPIDERRIG_API FSpiderSwarmGaitFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	float MotorValue{0};
+	float LaggedHorizontalSpeed{0};
+	float TimeSinceMovement{0};
+};
+
+// Legs sticking to the ground, one bit per leg
+USTRUCT()
+struct SPIDERRIG_API FSpiderSwarmFootContactFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	uint8 Contacts{0};
+};
+
+// Spine bobbing along the gait, a damped spring along the up axis
+USTRUCT()
+struct SPIDERRIG_API FSpiderSwarmSpineFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	float Offset{0};
+	float Velocity{0};
+};
+
+// Ground under a swarm spider, traced every few frames by the subsystem, the processor settles the spider on it
+USTRUCT()
+struct SPIDERRIG_API FSpiderSwarmGroundFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FTraceHandle TraceHandle;
+	float GroundZ{0};
+	bool bHasGround{false};
+};
+
+// Instance the spider is drawn with
+USTRUCT()
+struct SPIDERRIG_API FSpiderSwarmInstanceFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	int32 InstanceIndex{INDEX_NONE};
+};
+
+// Swarm the spider belongs to, shared by every spider of the swarm
+USTRUCT()
+struct SPIDERRIG_API FSpiderSwarmConfigFragment : public FMassConstSharedFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<USpiderSwarmConfig> Config;
+};
+
+// The spider is a full spider character for now, the entity waits for it to be demoted
+USTRUCT()
+struct SPIDERRIG_API FSpiderSwarmPromotedTag : public FMassTag
+{
+	GENERATED_BODY()
+};
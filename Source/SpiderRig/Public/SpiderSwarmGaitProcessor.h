@@ -0,0 +1,24 @@
+#pragma once
+
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "SpiderSwarmGaitProcessor.generated.h"
+
+// The gait of the spider rig for swarm spiders, spread over the worker threads chunk by chunk. Spiders walk
+// along their velocity and settle on the ground the subsystem traces for them, their motor and lagged speed
+// advance like the rig's and the gait curves decide which legs stick to the ground and how far the spine bobs.
+// Promoted spiders are left to their character.
+UCLASS()
+class SPIDERRIG_API USpiderSwarmGaitProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+	FMassEntityQuery EntityQuery;
+
+public:
+	USpiderSwarmGaitProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+};
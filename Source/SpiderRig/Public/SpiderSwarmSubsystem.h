@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "MassEntityQuery.h"
+#include "MassEntityTypes.h"
+#include "SpiderSwarmSubsystem.generated.h"
+
+class ASpiderCharacter;
+class UInstancedStaticMeshComponent;
+class USpiderSwarmConfig;
+
+// Swarm spider standing in as a full spider character
+struct FSpiderSwarmPromotion
+{
+	TWeakObjectPtr<ASpiderCharacter> Character;
+	int32 SwarmIndex{INDEX_NONE};
+	int32 InstanceIndex{INDEX_NONE};
+};
+
+// Background swarms of spiders as Mass entities, thousands of them at the cost of a few fragments each.
+// The gait processor walks them on the worker threads, the subsystem draws them as instances of the swarm's
+// mesh at the end of the frame and swaps the spiders close to a player with full spider characters, and back
+// once they are far enough again. Neither the entities nor the promoted characters replicate, swarms only run
+// on the server or in a standalone game and only its local players (e.g. a listen server's host) see them.
+UCLASS()
+class SPIDERRIG_API USpiderSwarmSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	// per swarm, one swarm per config
+	UPROPERTY()
+	TArray<TObjectPtr<USpiderSwarmConfig>> Configs;
+	UPROPERTY()
+	TArray<TObjectPtr<UInstancedStaticMeshComponent>> Instances;
+	TArray<TArray<FTransform>> InstanceTransforms;
+	TArray<int32> PromotedCounts;
+
+	TMap<FMassEntityHandle, FSpiderSwarmPromotion> Promotions;
+	uint32 GroundTraceFrame{0};
+	FMassArchetypeHandle Archetype;
+	FMassEntityQuery UpdateQuery;
+
+	int32 FindOrAddSwarm(USpiderSwarmConfig* Config);
+	void GatherViews(TArray<FVector, TInlineAllocator<4>>& OutViews) const;
+	void UpdateEntities(FMassEntityManager& EntityManager, const TArray<FVector, TInlineAllocator<4>>& Views,
+	                    const float& DeltaTime);
+	void DemoteCharacters(FMassEntityManager& EntityManager, const TArray<FVector, TInlineAllocator<4>>& Views);
+	void SteerCharacters(FMassEntityManager& EntityManager);
+	bool Promote(FMassEntityManager& EntityManager, const FMassEntityHandle& Entity);
+	float GetCapsuleHalfHeight(const int32& SwarmIndex) const;
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// Spawn a spider of the swarm at every transform, the transforms are where their feet are
+	void SpawnSwarm(USpiderSwarmConfig* Config, const TArray<FTransform>& Transforms,
+	                TArray<FMassEntityHandle>* OutEntities = nullptr);
+
+	// Steer a swarm spider, promoted spiders keep following it through their character movement
+	void SetVelocity(const FMassEntityHandle& Entity, const FVector& Velocity);
+};
@@ -9,7 +9,8 @@ public class SpiderRig : ModuleRules
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
 		PrivateDependencyModuleNames.AddRange([
-			"Core", "CoreUObject", "Engine", "EnhancedInput", "ControlRig", "RigVM", "AnimationCore", "Niagara"
+			"Core", "CoreUObject", "Engine", "EnhancedInput", "ControlRig", "RigVM", "AnimationCore", "Niagara", "Json",
+			"AnimationBudgetAllocator", "MassEntity", "MassCommon"
 		]);
 	}
 }
\ No newline at end of file